@@ -21,13 +21,40 @@
 #include "CRCTest.h"
 
 #include "crcstream.h"
+#include "crcbatch.h"
+#include "crcatm.h"
+#include "crccorrect.h"
+#include "crchash.h"
+#include "crchdlc.h"
+#include "crcmetrics.h"
+#include "crcpoly.h"
+#include "crcroll.h"
+#include "crcstreambuf.h"
+#include "crctune.h"
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <stdlib.h>     // mkdtemp
+#include <unistd.h>     // rmdir
 
 #include <cxxtest/RealDescriptions.h>
 
+using CrcPP::BatchVerifier;
+using CrcPP::CellDelineator;
 using CrcPP::CRC;
 using CrcPP::CRCResult;
+using CrcPP::CRCChunker;
+using CrcPP::CRCCorrector;
+using CrcPP::crc_hash;
+using CrcPP::CRCRolling;
 using CrcPP::CRCStream;
+using CrcPP::crc_streambuf;
+using CrcPP::GF2Poly;
+using CrcPP::HDLCDecoder;
+using CrcPP::HDLCEncoder;
 using CrcPP::Poly8;
 using CrcPP::Poly8N;
 using CrcPP::Poly16;
@@ -53,6 +80,328 @@ namespace
 
     // A test pattern used in each test
     ByteString testPattern(reinterpret_cast<uint8_t const*>("123456789"));
+
+    // Reproducible pseudo random test data
+    ByteString randomData(size_t len, uint32_t seed = 1);
+
+    // Compare addZeros() and addFill() against repeated add() for some lengths
+    template<typename P> bool checkFill(CRC<P> const& algorithm, uint8_t data)
+    {
+        size_t const lengths[] = { 0, 1, 2, 3, 7, 8, 100, 1000, 12345 };
+        bool ok = true;
+
+        for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+        {
+            P expected = ~0;
+            P reg = ~0;
+            P fill = ~0;
+
+            for (size_t n = 0; n < lengths[i]; ++n)
+            {
+                algorithm.add(data, expected);
+            }
+
+            if (data == 0)
+            {
+                algorithm.addZeros(lengths[i], reg);
+                ok = ok && reg == expected;
+            }
+
+            algorithm.addFill(data, lengths[i], fill);
+            ok = ok && fill == expected;
+        }
+
+        return ok;
+    }
+
+    // Force the CRC of data to a wanted value at several offsets, replace bytes, and remove zeros again
+    template<typename P> bool checkForce(CRC<P> const& algorithm, ByteString data)
+    {
+        typedef typename P::data_type data_type;
+        size_t const width = sizeof(data_type);
+        size_t const offsets[] = { 0, 1, data.size() / 2, data.size() - width };
+        P const wanted = static_cast<data_type>(0x0123456789ABCDEFULL);
+        bool ok = true;
+
+        for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+        {
+            ByteString old = data;
+            P crc = ~0;
+            algorithm.add(data.data(), data.size(), crc);
+
+            // The CRC of the changed data, computed from the changes only
+            algorithm.force(&data[offsets[i]], data.size() - offsets[i] - width, crc, wanted);
+            P replaced = algorithm.replace(crc, old.data() + offsets[i], data.data() + offsets[i],
+                                           width, data.size() - offsets[i] - width);
+
+            P reg = ~0;
+            algorithm.add(data.data(), data.size(), reg);
+            ok = ok && reg == wanted && replaced == wanted;
+        }
+
+        P reg = wanted;
+        algorithm.addZeros(12345, reg);
+        algorithm.removeZeros(12345, reg);
+        return ok && reg == wanted;
+    }
+
+    // Encode frames, some of them damaged, and decode them in chunks of the given size
+    template<typename P> bool checkHDLC(CRC<P> const& algorithm, size_t chunk)
+    {
+        size_t const fcsSize = sizeof(typename P::data_type);
+        HDLCEncoder<P> encoder(algorithm);
+        HDLCDecoder<P> decoder(algorithm, 1000 + fcsSize);
+        CRCStream<P> cs(algorithm);
+        ByteString data = randomData(3000, 31);
+
+        // Noise before the first flag is skipped
+        std::vector<uint8_t> line(10, 0x55);
+        std::vector<ByteString> frames;
+        std::vector<CrcPP::FrameStatus> expected;
+
+        for (size_t i = 0; i < 40; ++i)
+        {
+            ByteString frame = data.substr(i * 37 % 1500, i * i * 3 % 1200);
+
+            // Flags, escapes and control characters to be stuffed
+            if (frame.size() > 10)
+            {
+                frame[3] = 0x7E;
+                frame[4] = 0x7D;
+                frame[5] = 0x11;
+            }
+
+            size_t start = line.size();
+            encoder.encode(frame.data(), frame.size(), line);
+            CrcPP::FrameStatus status = frame.size() > 1000 ? CrcPP::FrameTooLong : CrcPP::FrameGood;
+
+            // Flags only at the ends, and no control characters
+            for (size_t j = start + 1; j + 1 < line.size(); ++j)
+            {
+                if (line[j] == 0x7E || line[j] < 0x20)
+                {
+                    return false;
+                }
+            }
+
+            if (i % 7 == 3 && status == CrcPP::FrameGood)
+            {
+                // Damage a byte which is neither a flag nor an escape, before or after the damage
+                size_t j = start + 1;
+
+                while (line[j] == 0x7D || line[j] == 0x7E || (line[j] ^ 0x01) == 0x7D || (line[j] ^ 0x01) == 0x7E)
+                {
+                    ++j;
+                }
+
+                line[j] ^= 0x01;
+                status = CrcPP::FrameBadFCS;
+            }
+
+            if (i % 9 == 4)
+            {
+                // The abort sequence instead of the closing flag, which opens the next frame
+                line.back() = 0x7D;
+                line.push_back(0x7E);
+                status = CrcPP::FrameAborted;
+            }
+
+            if (i % 5 == 2)
+            {
+                // Empty frames are skipped
+                line.push_back(0x7E);
+                line.push_back(0x7E);
+            }
+
+            frames.push_back(frame);
+            expected.push_back(status);
+        }
+
+        // A frame shorter than its FCS
+        line.push_back(0x41);
+        line.push_back(0x7E);
+        frames.push_back(ByteString());
+        expected.push_back(CrcPP::FrameTooShort);
+
+        size_t count = 0;
+        bool ok = true;
+
+        for (size_t offset = 0; offset < line.size(); offset += chunk)
+        {
+            uint8_t const* pos = &line[offset];
+            size_t len = std::min(chunk, line.size() - offset);
+
+            for (size_t n; (n = decoder.next(pos, len)) != 0; pos += n, len -= n, ++count)
+            {
+                ok = ok && count < frames.size() && decoder.status() == expected[count];
+
+                if (ok && decoder.good())
+                {
+                    ok = ByteString(decoder.frame(), decoder.size()) == frames[count] &&
+                         cs.check(decoder.frame(), decoder.size() + fcsSize);
+                }
+            }
+        }
+
+        return ok && count == frames.size();
+    }
+
+    // Compare the fixed length add() of N bytes against the bulk add() of the reference, at several offsets
+    template<typename P, size_t N> bool checkFixed(CRC<P> const& reference, CRC<P> const& algorithm, ByteString const& data)
+    {
+        bool ok = true;
+
+        for (size_t offset = 0; offset + N <= data.size(); offset += 13)
+        {
+            uint8_t block[N];
+            std::memcpy(block, data.data() + offset, N);
+
+            P expected = static_cast<typename P::data_type>(0x9E3779B97F4A7C15ULL * (offset + 1));
+            P reg = expected;
+
+            reference.add(block, N, expected);
+            algorithm.add(block, reg);
+            ok = ok && reg == expected;
+        }
+
+        return ok;
+    }
+
+    // Fixed lengths around the 8 and 16 byte blocks, and beyond the unrolled ones
+    template<typename P> bool checkFixed(CRC<P> const& reference, CRC<P> const& algorithm)
+    {
+        ByteString data = randomData(200, 17);
+
+        return checkFixed<P, 1>(reference, algorithm, data) && checkFixed<P, 2>(reference, algorithm, data) &&
+               checkFixed<P, 3>(reference, algorithm, data) && checkFixed<P, 4>(reference, algorithm, data) &&
+               checkFixed<P, 5>(reference, algorithm, data) && checkFixed<P, 7>(reference, algorithm, data) &&
+               checkFixed<P, 8>(reference, algorithm, data) && checkFixed<P, 9>(reference, algorithm, data) &&
+               checkFixed<P, 12>(reference, algorithm, data) && checkFixed<P, 15>(reference, algorithm, data) &&
+               checkFixed<P, 16>(reference, algorithm, data) && checkFixed<P, 17>(reference, algorithm, data) &&
+               checkFixed<P, 64>(reference, algorithm, data) && checkFixed<P, 100>(reference, algorithm, data);
+    }
+
+    // Compare all kernels supported on this CPU against the table kernel, for all lengths
+    // up to a few folding blocks and at all alignments
+    template<typename P> bool checkKernels(P generator)
+    {
+        // Slicing tables where the polynomial allows them, so the slicing kernel is checked as well
+        CrcPP::Tables tables = P::numbits == sizeof(typename P::data_type) * 8 ? CrcPP::TablesSlicing8 : CrcPP::TablesByte;
+        CRC<P> reference(generator, tables, CrcPP::KernelTable);
+        ByteString data = randomData(4200, 11);
+        bool ok = reference.kernel() == CrcPP::KernelTable;
+
+        for (int kernel = CrcPP::KernelTable; kernel < CrcPP::numKernels; ++kernel)
+        {
+            if (!reference.supports(static_cast<CrcPP::Kernel>(kernel)))
+            {
+                continue;
+            }
+
+            CRC<P> algorithm(generator, tables, static_cast<CrcPP::Kernel>(kernel));
+
+            for (size_t len = 0; len <= 4150; len += (len < 300 ? 1 : 37))
+            {
+                size_t offset = len % 17;
+                P expected = ~0;
+                P reg = ~0;
+
+                reference.add(data.data() + offset, len, expected);
+                algorithm.add(data.data() + offset, len, reg);
+                ok = ok && reg == expected;
+            }
+
+            // Several buffers at once, with lengths which differ in every lane
+            uint8_t const* buffers[9];
+            size_t lengths[9];
+            P regs[9];
+
+            for (size_t len = 0; len <= 1050; len += 13)
+            {
+                for (size_t i = 0; i < 9; ++i)
+                {
+                    buffers[i] = data.data() + i;
+                    lengths[i] = (len * (i + 1)) % 1051;
+                    regs[i] = static_cast<typename P::data_type>(i);
+                }
+
+                algorithm.add(buffers, lengths, regs, 9);
+
+                for (size_t i = 0; i < 9; ++i)
+                {
+                    P expected = static_cast<typename P::data_type>(i);
+                    reference.add(buffers[i], lengths[i], expected);
+                    ok = ok && regs[i] == expected;
+                }
+            }
+
+            ok = ok && checkFixed(reference, algorithm);
+        }
+
+        return ok;
+    }
+
+    // Compare all tables and the kernels they support against the byte table
+    template<typename P> bool checkTables(P generator)
+    {
+        CRC<P> reference(generator, CrcPP::TablesByte, CrcPP::KernelTable);
+        ByteString data = randomData(300, 13);
+        bool ok = true;
+
+        for (int tables = CrcPP::TablesNone; tables <= CrcPP::TablesWord; ++tables)
+        {
+            if ((tables == CrcPP::TablesSlicing4 && P::numbits > 32) || (tables == CrcPP::TablesWord && P::numbits < 16))
+            {
+                continue;
+            }
+
+            CRC<P> algorithm(generator, static_cast<CrcPP::Tables>(tables));
+
+            for (int kernel = CrcPP::KernelTable; kernel < CrcPP::numKernels; ++kernel)
+            {
+                if (!algorithm.supports(static_cast<CrcPP::Kernel>(kernel)))
+                {
+                    continue;
+                }
+
+                algorithm.setKernel(static_cast<CrcPP::Kernel>(kernel));
+
+                for (size_t len = 0; len <= data.size(); len += 7)
+                {
+                    P expected = ~0;
+                    P reg = ~0;
+                    P bytes = ~0;
+
+                    reference.add(data.data() + 1, len, expected);
+                    algorithm.add(data.data() + 1, len, reg);
+
+                    for (size_t i = 0; i < len; ++i)
+                    {
+                        algorithm.add(data[i + 1], bytes);
+                    }
+
+                    ok = ok && reg == expected && bytes == expected;
+                }
+
+                ok = ok && checkFixed(reference, algorithm);
+            }
+        }
+
+        return ok;
+    }
+
+    ByteString randomData(size_t len, uint32_t seed)
+    {
+        ByteString data(len, 0);
+
+        for (size_t i = 0; i < len; ++i)
+        {
+            seed = seed * 1103515245U + 12345U;
+            data[i] = static_cast<uint8_t>(seed >> 16);
+        }
+
+        return data;
+    }
 }
 
 CRCTest::CRCTest()
@@ -233,3 +582,1005 @@ void CRCTest::testCanCrC15()
     // Recorded test data concatenates CRC and (recessive) delimiter bit to one 16 bit word
     TS_ASSERT((result << 1 | 1) == 0xe961);
 }
+
+void CRCTest::testRolling()
+{
+    std::cout << "Testing rolling CRC...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRC<Poly16> CRCx(0x1021);
+    size_t const window = 48;
+
+    CRCRolling<Poly32N> rolling32(CRC_ETHER, window);
+    CRCRolling<Poly16> rolling16(CRCx, window);
+
+    ByteString data = randomData(1000);
+
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        rolling32.add(data[i]);
+        rolling16.add(data[i]);
+
+        size_t start = i + 1 > window ? i + 1 - window : 0;
+        Poly32N reg32 = 0;
+        Poly16 reg16 = 0;
+        CRC_ETHER.add(data.data() + start, static_cast<unsigned int>(i + 1 - start), reg32);
+        CRCx.add(data.data() + start, static_cast<unsigned int>(i + 1 - start), reg16);
+
+        TS_ASSERT(rolling32.crc() == reg32);
+        TS_ASSERT(rolling16.crc() == reg16);
+    }
+
+    // Bulk add after reset gives the CRC of the last window
+    Poly32N last = rolling32.crc();
+    rolling32.reset();
+    TS_ASSERT(rolling32.crc() == 0);
+    TS_ASSERT(rolling32.add(data.data(), data.size()) == last);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testChunker()
+{
+    std::cout << "Testing content defined chunking...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    size_t const minSize = 64;
+    size_t const maxSize = 1024;
+
+    ByteString data = randomData(20000) + ByteString(5000, 0) + randomData(20000, 2);
+
+    // Reference: the whole data at once
+    std::vector<size_t> boundaries;
+    CRCChunker<Poly32N> chunker(CRC_ETHER, 32, 0xFF, minSize, maxSize);
+
+    for (size_t pos = 0, n; (n = chunker.next(data.data() + pos, data.size() - pos)) != 0; )
+    {
+        pos += n;
+        boundaries.push_back(pos);
+    }
+
+    TS_ASSERT(boundaries.size() > 20);
+
+    for (size_t i = 0; i < boundaries.size(); ++i)
+    {
+        size_t size = boundaries[i] - (i > 0 ? boundaries[i - 1] : 0);
+        TS_ASSERT(size >= minSize && size <= maxSize);
+    }
+
+    // The same data in odd pieces
+    std::vector<size_t> pieces;
+    chunker.reset();
+
+    for (size_t pos = 0; pos < data.size(); )
+    {
+        size_t len = std::min<size_t>(97, data.size() - pos);
+        size_t n = chunker.next(data.data() + pos, len);
+        pos += n != 0 ? n : len;
+
+        if (n != 0)
+        {
+            pieces.push_back(pos);
+        }
+    }
+
+    TS_ASSERT(pieces == boundaries);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testZeros()
+{
+    std::cout << "Testing zero and fill append...";
+
+    TS_ASSERT(checkFill(CRC<Poly8N>(0xE0), 0));
+    TS_ASSERT(checkFill(CRC<Poly8>(0x07), 0xA5));
+    TS_ASSERT(checkFill(CRC<Poly16N>(0x8408), 0));
+    TS_ASSERT(checkFill(CRC<Poly16>(0x1021), 0xFF));
+    TS_ASSERT(checkFill(CRC<Poly32N>(0xEDB88320), 0));
+    TS_ASSERT(checkFill(CRC<Poly32N>(0xEDB88320), 0x5A));
+    TS_ASSERT(checkFill(CRC<Poly32>(0x04C11DB7), 0));
+    TS_ASSERT(checkFill(CRC<Poly64N>(0xd800000000000000ULL), 0x01));
+    TS_ASSERT(checkFill(CRC<Poly64>(0x000000000000001BULL), 0));
+
+    // A CRC over data with a long run of zeros in the middle
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream<Poly32N> cs(CRC_ETHER);
+    ByteString data = testPattern + ByteString(100000, 0) + testPattern;
+    CRCResult<Poly32N> sResult = cs.gen(data);
+
+    cs.reset();
+    cs << testPattern;
+    cs.addZeros(100000);
+    cs << testPattern;
+    TS_ASSERT(cs.result() == sResult.c_str());
+
+    // The same data in three blocks, each added to a zero register on its own and then combined
+    size_t const blocks[] = { testPattern.size(), 100000, testPattern.size() };
+    size_t offset = 0;
+    cs.reset();
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        Poly32N reg = 0;
+        CRC_ETHER.add(data.data() + offset, blocks[i], reg);
+        cs.combine(reg, blocks[i]);
+        offset += blocks[i];
+    }
+
+    TS_ASSERT(cs.result() == sResult.c_str());
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testForce()
+{
+    std::cout << "Testing CRC forcing...";
+
+    ByteString data = randomData(1000, 29);
+    TS_ASSERT(checkForce(CRC<Poly8>(0x07), data));
+    TS_ASSERT(checkForce(CRC<Poly16N>(0x8408), data));
+    TS_ASSERT(checkForce(CRC<Poly16>(0x1021), data));
+    TS_ASSERT(checkForce(CRC<Poly32N>(0xEDB88320), data));
+    TS_ASSERT(checkForce(CRC<Poly32>(0x04C11DB7), data));
+    TS_ASSERT(checkForce(CRC<Poly64N>(0xC96C5795D7870F42ULL), data));
+    TS_ASSERT(checkForce(CRC<Poly64>(0x42F0E1EBA9EA3693ULL), data));
+
+    // A frame which keeps its CRC after a patch: the four bytes after the patch absorb the change
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream<Poly32N> cs(CRC_ETHER);
+    ByteString frame = data + cs.gen(data);
+    Poly32N original = ~0;
+    CRC_ETHER.add(data.data(), data.size(), original);
+
+    ByteString patched = data;
+    patched.replace(100, 5, reinterpret_cast<uint8_t const*>("PATCH"), 5);
+    Poly32N crc = CRC_ETHER.replace(original, data.data() + 100, patched.data() + 100, 5, data.size() - 105);
+    CRC_ETHER.force(&patched[105], data.size() - 109, crc, original);
+    TS_ASSERT(patched.substr(100, 5) == ByteString(reinterpret_cast<uint8_t const*>("PATCH"), 5));
+    TS_ASSERT(cs.check(patched + frame.substr(data.size())));
+
+    // CRC forcing is limited to polynomials which fill their data type
+    CRC<CrcPP::Poly<uint16_t, 15> > CRC_CAN(0x4599);
+    CrcPP::Poly<uint16_t, 15> reg = 0;
+    TS_ASSERT_THROWS(CRC_CAN.force(&patched[0], 0, reg, reg), std::logic_error);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testScatterGather()
+{
+    std::cout << "Testing scatter/gather input...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream <Poly32N> cs(CRC_ETHER);
+
+    ByteString data = randomData(1500);
+    CRCResult<Poly32N> sResult = cs.gen(data);
+    ByteString frame = data + sResult;
+
+    // Header, two payload fragments, and a fragment with part of the payload and part of the CRC
+    size_t const cuts[] = { 0, 14, 700, 1498, frame.size() };
+    struct iovec iov[4];
+    std::vector<ByteString> segments;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        iov[i].iov_base = const_cast<uint8_t*>(frame.data() + cuts[i]);
+        iov[i].iov_len = cuts[i + 1] - cuts[i];
+        segments.push_back(frame.substr(cuts[i], cuts[i + 1] - cuts[i]));
+    }
+
+    TS_ASSERT(cs.check(iov, 4));
+    TS_ASSERT(cs.check(iov, 4U));
+
+    // Without the CRC bytes
+    iov[3].iov_len -= sResult.size();
+    TS_ASSERT(cs.gen(iov, 4) == sResult.c_str());
+    iov[3].iov_len += sResult.size();
+
+    cs.reset();
+    cs.addSegments(segments);
+    TS_ASSERT(cs.good());
+
+    // A chain of small fragments, gathered before they are added, mixed with long ones
+    std::vector<struct iovec> small;
+
+    for (size_t pos = 0, i = 0; pos < frame.size(); ++i)
+    {
+        size_t len = i % 7 == 6 ? 300 : i % 5 + 1;
+        struct iovec v = { const_cast<uint8_t*>(frame.data() + pos), std::min(len, frame.size() - pos) };
+        small.push_back(v);
+        pos += v.iov_len;
+    }
+
+    TS_ASSERT(cs.check(&small[0], small.size()));
+
+    // A corrupted fragment must be detected
+    frame[800] ^= 0x10;
+    TS_ASSERT(!cs.check(iov, 4));
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testStreamBuffer()
+{
+    std::cout << "Testing CRC stream buffer...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream <Poly32N> expected(CRC_ETHER);
+    ByteString data = randomData(100000);
+    CRCResult<Poly32N> sResult = expected.gen(data);
+
+    // Output: small and large writes through an ostream
+    std::stringbuf sink;
+    CRCStream <Poly32N> written(CRC_ETHER);
+    {
+        crc_streambuf<Poly32N> buffer(&sink, written, 1000);
+        std::ostream out(&buffer);
+
+        out.write(reinterpret_cast<char const*>(data.data()), 10);
+
+        for (size_t i = 10; i < 20; ++i)
+        {
+            out << static_cast<char>(data[i]);
+        }
+
+        out.write(reinterpret_cast<char const*>(data.data()) + 20, 5000);
+        out.write(reinterpret_cast<char const*>(data.data()) + 5020, static_cast<std::streamsize>(data.size() - 5020));
+        out.flush();
+        TS_ASSERT(written.result() == sResult.c_str());
+    }
+    TS_ASSERT(sink.str().size() == data.size());
+
+    // Output: a wrapped stream buffer which takes at most 300 bytes at a time must not lose the rest
+    struct SlowSink : std::stringbuf
+    {
+        std::streamsize xsputn(char const* s, std::streamsize n)
+        {
+            return std::stringbuf::xsputn(s, n < 300 ? n : 300);
+        }
+    } slow;
+    CRCStream <Poly32N> partial(CRC_ETHER);
+    {
+        crc_streambuf<Poly32N> buffer(&slow, partial, 1000);
+        std::ostream out(&buffer);
+
+        out.write(reinterpret_cast<char const*>(data.data()), 800);
+        TS_ASSERT(!out.flush());
+
+        for (int i = 0; i < 3; ++i)
+        {
+            out.clear();
+            out.flush();
+        }
+
+        TS_ASSERT(out.good());
+        TS_ASSERT(slow.str().size() == 800);
+        TS_ASSERT(std::memcmp(slow.str().data(), data.data(), 800) == 0);
+        TS_ASSERT(partial.result() == expected.gen(data.data(), 800).c_str());
+    }
+
+    // Input: read everything back through an istream
+    CRCStream <Poly32N> read(CRC_ETHER);
+    crc_streambuf<Poly32N> buffer(&sink, read, 4096);
+    std::istream in(&buffer);
+    std::vector<char> back(data.size());
+
+    in.read(&back[0], 3);
+    in.read(&back[3], 10000);
+    TS_ASSERT(in.get(back[10003]));
+    in.read(&back[10004], static_cast<std::streamsize>(data.size() - 10004));
+
+    TS_ASSERT(in.good());
+    TS_ASSERT(in.peek() == std::char_traits<char>::eof());
+    TS_ASSERT(std::memcmp(&back[0], data.data(), data.size()) == 0);
+    TS_ASSERT(read.result() == sResult.c_str());
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testCopyAndAdd()
+{
+    std::cout << "Testing copy and CRC...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    ByteString data = randomData(1000003);
+    size_t const sizes[] = { 0, 1, 100, 4097, data.size() - 5 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        ByteString copy(sizes[i] + 5, 0);
+        Poly32N expected = ~0;
+        Poly32N reg = ~0;
+
+        CRC_ETHER.add(data.data() + 3, sizes[i], expected);
+        CRC_ETHER.copyAndAdd(&copy[1], data.data() + 3, sizes[i], reg);
+
+        TS_ASSERT(reg == expected);
+        TS_ASSERT(copy.compare(1, sizes[i], data, 3, sizes[i]) == 0);
+        TS_ASSERT(copy[0] == 0 && copy[sizes[i] + 1] == 0);
+    }
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testState()
+{
+    std::cout << "Testing state export and import...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream<Poly32N> cs(CRC_ETHER);
+    ByteString data = randomData(1000, 3);
+    CRCResult<Poly32N> sResult = cs.gen(data);
+    TS_ASSERT(cs.length() == 1000);
+
+    cs.reset();
+    cs.add(data.data(), 600);
+    std::vector<uint8_t> state = cs.exportState();
+    TS_ASSERT(state.size() == CRCStream<Poly32N>::stateSize);
+
+    CRCStream<Poly32N> resumed(CRC_ETHER);
+    TS_ASSERT(resumed.importState(state.data(), state.size()));
+    TS_ASSERT(resumed.length() == 600);
+    resumed.add(data.data() + 600, 400);
+    TS_ASSERT(resumed.result() == sResult.c_str());
+
+    // Other preset, other polynomial, damaged state
+    CRCStream<Poly32N> other(CRC_ETHER, 0, 0);
+    TS_ASSERT(!other.importState(state.data(), state.size()));
+
+    CRC<Poly32N> CRC_CASTAGNOLI(0x82F63B78);
+    CRCStream<Poly32N> castagnoli(CRC_CASTAGNOLI);
+    TS_ASSERT(!castagnoli.importState(state.data(), state.size()));
+
+    state[0] ^= 1;
+    TS_ASSERT(!resumed.importState(state.data(), state.size()));
+    TS_ASSERT(resumed.length() == 1000);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testKernels()
+{
+    std::cout << "Testing kernels...";
+
+    TS_ASSERT(checkKernels(Poly32N(0xEDB88320)));
+    TS_ASSERT(checkKernels(Poly32N(0x82F63B78)));
+    TS_ASSERT(checkKernels(Poly32(0x04C11DB7)));
+    TS_ASSERT(checkKernels(Poly16N(0x8408)));
+    TS_ASSERT(checkKernels(Poly16(0x8005)));
+    TS_ASSERT(checkKernels(Poly64N(0xC96C5795D7870F42ULL)));
+    TS_ASSERT(checkKernels(Poly64(0x42F0E1EBA9EA3693ULL)));
+    TS_ASSERT(checkKernels(Poly8N(0xE0)));
+    TS_ASSERT(checkKernels(Poly8(0x07)));
+
+    // CRC-32C check value, and a kernel which does not fit the polynomial
+    CRC<Poly32N> CRC_CASTAGNOLI(0x82F63B78);
+    Poly32N reg = ~0;
+    CRC_CASTAGNOLI.add(testPattern.data(), testPattern.size(), reg);
+    TS_ASSERT(static_cast<uint32_t>(~reg) == 0xE3069283U);
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    TS_ASSERT(!CRC_ETHER.supports(CrcPP::KernelCRC32C));
+    TS_ASSERT_THROWS(CRC_ETHER.setKernel(CrcPP::KernelCRC32C), std::runtime_error);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testTables()
+{
+    std::cout << "Testing table sizes...";
+
+    TS_ASSERT(checkTables(Poly32N(0xEDB88320)));
+    TS_ASSERT(checkTables(Poly32(0x04C11DB7)));
+    TS_ASSERT(checkTables(Poly16N(0x8408)));
+    TS_ASSERT(checkTables(Poly16(0x1021)));
+    TS_ASSERT(checkTables(Poly64N(0xC96C5795D7870F42ULL)));
+    TS_ASSERT(checkTables(Poly8(0x07)));
+
+    // No tables at all still gives the check value
+    CRC<Poly16N> CRC_CCITT(0x8408, CrcPP::TablesNone, CrcPP::KernelTable);
+    CRCStream<Poly16N> cs(CRC_CCITT);
+    cs << testPattern;
+    TS_ASSERT(CRC_CCITT.table() == 0);
+    TS_ASSERT(cs.result() == "\x6E\x90");
+
+    // Fixed length data of a polynomial which does not fill its data type (CAN)
+    CRC<CrcPP::Poly<uint16_t, 15> > CRC_CAN(0x4599);
+    TS_ASSERT(checkFixed(CRC_CAN, CRC_CAN));
+
+    // Table sizes which do not fit the polynomial
+    TS_ASSERT_THROWS(CRC<Poly64>(0x42F0E1EBA9EA3693ULL, CrcPP::TablesSlicing4), std::logic_error);
+    TS_ASSERT_THROWS(CRC<Poly8>(0x07, CrcPP::TablesWord), std::logic_error);
+    TS_ASSERT_THROWS((CRC<CrcPP::Poly<uint16_t, 15> >(0x4599, CrcPP::TablesSlicing8)), std::logic_error);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testCorrection()
+{
+    std::cout << "Testing error correction...";
+
+    // ATM HEC: every single bit error in the 5 byte header is correctable
+    CRC<Poly8N> CRC8(0XE0);
+    CRCStream <Poly8N> hec(CRC8, 0, 0x55);
+    CRCCorrector<Poly8N> hecCorrector(CRC8, 5);
+
+    ByteString header = randomData(4, 7);
+    header = header + hec.gen(header);
+
+    for (size_t bit = 0; bit < 40; ++bit)
+    {
+        ByteString cell = header;
+        cell[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        TS_ASSERT(hecCorrector.correct(hec, &cell[0]) == 1);
+        TS_ASSERT(cell == header);
+    }
+
+    ByteString cell = header;
+    TS_ASSERT(hecCorrector.correct(hec, &cell[0]) == 0);
+
+    // A frame longer than the period of the generator: single bit errors share syndromes, possibly
+    // three or more of them, and must never be "corrected" by flipping another bit
+    CRCCorrector<Poly8N> longCorrector(CRC8, 40);
+    ByteString longData = randomData(39, 11);
+    ByteString longFrame = longData + hec.gen(longData);
+
+    for (size_t bit = 0; bit < longFrame.size() * 8; ++bit)
+    {
+        ByteString copy = longFrame;
+        copy[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        int corrected = longCorrector.correct(hec, &copy[0]);
+        TS_ASSERT(corrected == CRCCorrector<Poly8N>::uncorrectable || (corrected == 1 && copy == longFrame));
+    }
+
+    cell = longFrame;
+    cell[0] ^= 0x01;
+    TS_ASSERT(longCorrector.correct(hec, &cell[0]) == CRCCorrector<Poly8N>::uncorrectable);
+
+    // CRC-CCITT has Hamming distance 4: single bit errors can be corrected
+    CRC<Poly16N> CRC_CCITT(0x8408);
+    CRCStream <Poly16N> cs(CRC_CCITT);
+    ByteString data = randomData(62, 3);
+    ByteString frame = data + cs.gen(data);
+    CRCCorrector<Poly16N> single(CRC_CCITT, frame.size());
+
+    for (size_t bit = 0; bit < frame.size() * 8; bit += 7)
+    {
+        ByteString copy = frame;
+        copy[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        TS_ASSERT(single.correct(cs, &copy[0]) == 1);
+        TS_ASSERT(copy == frame);
+    }
+
+    ByteString copy = frame;
+    copy[3] ^= 0x01;
+    copy[40] ^= 0x80;
+    TS_ASSERT(single.correct(cs, &copy[0]) == CRCCorrector<Poly16N>::uncorrectable);
+
+    // CRC-32 has Hamming distance 6 for short frames: double bit errors can be corrected
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRCStream <Poly32N> ether(CRC_ETHER);
+    data = randomData(60, 5);
+    frame = data + ether.gen(data);
+    CRCCorrector<Poly32N> doubles(CRC_ETHER, frame.size(), 2);
+
+    for (size_t first = 0; first < frame.size() * 8; first += 13)
+    {
+        for (size_t second = first + 1; second < frame.size() * 8; second += 29)
+        {
+            copy = frame;
+            copy[first / 8] ^= static_cast<uint8_t>(1 << (first % 8));
+            copy[second / 8] ^= static_cast<uint8_t>(1 << (second % 8));
+            TS_ASSERT(doubles.correct(ether, &copy[0]) == 2);
+            TS_ASSERT(copy == frame);
+        }
+    }
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testHash()
+{
+    std::cout << "Testing hashing...";
+
+    // The default seed gives the standard check values
+    crc_hash<> hash32c;
+    TS_ASSERT(hash32c("123456789") == 0xE3069283U);
+    TS_ASSERT(crc_hash<CrcPP::CRC32>()(std::string("123456789")) == 0xCBF43926U);
+    TS_ASSERT(static_cast<uint64_t>(crc_hash<CrcPP::CRC64>()("123456789")) == static_cast<size_t>(0x995DC9BBDF1939FAULL));
+    TS_ASSERT(crc_hash<>(0)("123456789") != hash32c("123456789"));
+
+    // Numbers are hashed by their bytes
+    uint32_t number = 0x12345678;
+    TS_ASSERT(hash32c(number) == hash32c(&number, sizeof(number)));
+    TS_ASSERT(hash32c(1.5) == hash32c(1.5));
+
+    std::unordered_map<std::string, int, crc_hash<> > map;
+    map["one"] = 1;
+    map["two"] = 2;
+    TS_ASSERT(map["one"] == 1 && map["two"] == 2 && map.size() == 2);
+
+    // A column of keys of all lengths, as single keys
+    ByteString data = randomData(20000, 19);
+    std::vector<uint32_t> offsets(1, 0);
+
+    while (offsets.back() < data.size() - 700)
+    {
+        offsets.push_back(offsets.back() + (offsets.size() * 37) % (offsets.size() % 10 == 0 ? 700 : 40));
+    }
+
+    std::vector<size_t> hashes(offsets.size() - 1);
+    crc_hash<CrcPP::CRC32C> seeded(0x1234);
+    seeded.hashColumn(data.data(), &offsets[0], hashes.size(), &hashes[0]);
+    bool ok = true;
+
+    for (size_t i = 0; i < hashes.size(); ++i)
+    {
+        ok = ok && hashes[i] == seeded(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    TS_ASSERT(ok);
+
+    crc_hash<CrcPP::CRC64> hash64;
+    hash64.hashColumn(data.data(), &offsets[0], hashes.size(), &hashes[0]);
+
+    for (size_t i = 0; i < hashes.size(); ++i)
+    {
+        ok = ok && hashes[i] == hash64(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    TS_ASSERT(ok);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testBatchVerifier()
+{
+    std::cout << "Testing batch verification...";
+
+    CRC<Poly32N> CRC_ETHER(0xEDB88320);
+    CRC<Poly16N> CRC_CCITT(0x8408);
+    CRCStream<Poly32N> ether(CRC_ETHER);
+    CRCStream<Poly16N> ccitt(CRC_CCITT);
+    BatchVerifier::Check<Poly32N> checkEther(CRC_ETHER);
+    BatchVerifier::Check<Poly16N> checkCCITT(CRC_CCITT);
+
+    // Messages of both algorithms, in runs of varying length, some of them damaged
+    ByteString data = randomData(3000, 23);
+    std::vector<ByteString> messages;
+    std::vector<BatchVerifier::Job> jobs;
+    std::vector<bool> expected;
+
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        ByteString message = data.substr(i % 1000, (i * 7) % 1500);
+        bool isEther = (i / 3) % 5 < 3;
+        message = isEther ? message + ether.gen(message) : message + ccitt.gen(message);
+
+        if (i % 11 == 0)
+        {
+            message[(i * 13) % message.size()] ^= 0x10;
+        }
+
+        messages.push_back(message);
+        expected.push_back(i % 11 != 0);
+    }
+
+    for (size_t i = 0; i < messages.size(); ++i)
+    {
+        BatchVerifier::Algorithm const* algorithm = &checkCCITT;
+
+        if ((i / 3) % 5 < 3)
+        {
+            algorithm = &checkEther;
+        }
+
+        BatchVerifier::Job job = { messages[i].data(), messages[i].size(), algorithm };
+        jobs.push_back(job);
+    }
+
+    BatchVerifier verifier(3);
+    TS_ASSERT(verifier.numThreads() == 3);
+    TS_ASSERT(verifier.verify(&jobs[0], 0).empty());
+
+    // Several batches at once, from several threads
+    std::vector<uint64_t> bitmaps[4];
+    std::vector<std::thread> producers;
+
+    for (size_t p = 0; p < 4; ++p)
+    {
+        producers.push_back(std::thread([&, p]()
+        {
+            bitmaps[p] = verifier.verify(&jobs[0], jobs.size() - 100 * p);
+        }));
+    }
+
+    for (size_t p = 0; p < producers.size(); ++p)
+    {
+        producers[p].join();
+    }
+
+    bool ok = true;
+
+    for (size_t p = 0; p < 4; ++p)
+    {
+        size_t count = jobs.size() - 100 * p;
+        ok = ok && bitmaps[p].size() == (count + 63) / 64;
+
+        for (size_t i = 0; ok && i < count; ++i)
+        {
+            ok = BatchVerifier::good(bitmaps[p], i) == expected[i];
+        }
+
+        // No bits beyond the last job
+        ok = ok && (count % 64 == 0 || (bitmaps[p].back() >> (count % 64)) == 0);
+    }
+
+    TS_ASSERT(ok);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testPolynomials()
+{
+    std::cout << "Testing polynomial arithmetic...";
+
+    // Both bit orders give the same polynomial, and back
+    GF2Poly ether = GF2Poly::generator(Poly32N(0xEDB88320));
+    TS_ASSERT(ether == GF2Poly::generator(Poly32(0x04C11DB7)));
+    TS_ASSERT(ether.degree() == 32 && ether.weight() == 15);
+    TS_ASSERT(static_cast<uint32_t>(ether.toGenerator<Poly32N>()) == 0xEDB88320);
+    TS_ASSERT(static_cast<uint32_t>(ether.toGenerator<Poly32>()) == 0x04C11DB7);
+    TS_ASSERT_THROWS(ether.toGenerator<Poly16>(), std::logic_error);
+
+    std::ostringstream text;
+    text << GF2Poly::generator(Poly16(0x1021));
+    TS_ASSERT(text.str() == "X^16 + X^12 + X^5 + 1");
+
+    // Division undoes multiplication, also beyond 64 bits
+    GF2Poly a = GF2Poly::monomial(150) + GF2Poly(0x9E3779B97F4A7C15ULL) * GF2Poly::monomial(40);
+    GF2Poly b = GF2Poly::monomial(70) + GF2Poly(0x123456789ULL);
+    GF2Poly r = GF2Poly(0xABCDEF);
+    GF2Poly quotient, remainder;
+    GF2Poly::divide(a * b + r, b, quotient, remainder);
+    TS_ASSERT(quotient == a && remainder == r);
+    TS_ASSERT((a * b).degree() == 220);
+    TS_ASSERT(GF2Poly::gcd(a * ether, b * ether) % ether == GF2Poly());
+    TS_ASSERT_THROWS(a % GF2Poly(), std::logic_error);
+
+    // X has the order 2^32 - 1 modulo the Ethernet generator, which is primitive
+    TS_ASSERT(GF2Poly(2).powMod(0xFFFFFFFFULL, ether) == GF2Poly(1));
+    TS_ASSERT(GF2Poly(2).powMod(0xFFFFFFFFULL / 3, ether) != GF2Poly(1));
+    TS_ASSERT(ether.isIrreducible() && ether.isPrimitive());
+
+    // X^4 + X^3 + X^2 + X + 1 divides X^5 + 1: irreducible, but not primitive
+    TS_ASSERT(GF2Poly(0x1F).isIrreducible() && !GF2Poly(0x1F).isPrimitive());
+    TS_ASSERT(!GF2Poly(0x15).isIrreducible());
+
+    // CRC-CCITT and CRC-32C: X + 1 times a primitive polynomial
+    std::vector<GF2Poly::Factor> factors = GF2Poly::generator(Poly16(0x1021)).factor();
+    TS_ASSERT(factors.size() == 2 && factors[0].poly == GF2Poly(3) && factors[1].poly.degree() == 15);
+    TS_ASSERT(factors[1].poly.isPrimitive());
+
+    factors = GF2Poly::generator(Poly32N(0x82F63B78)).factor();
+    TS_ASSERT(factors.size() == 2 && factors[0].poly == GF2Poly(3) && factors[1].poly.degree() == 31);
+
+    // CRC-64 of ECMA-182: (X + 1)^2 and four more factors, which multiply to the generator
+    GF2Poly ecma = GF2Poly::generator(Poly64(0x42F0E1EBA9EA3693ULL));
+    factors = ecma.factor();
+    GF2Poly product = 1;
+
+    for (size_t i = 0; i < factors.size(); ++i)
+    {
+        TS_ASSERT(factors[i].poly.isIrreducible());
+        product *= factors[i].poly.pow(factors[i].multiplicity);
+    }
+
+    TS_ASSERT(product == ecma);
+    TS_ASSERT(factors.size() == 5 && factors[0].poly == GF2Poly(3) && factors[0].multiplicity == 2);
+
+    // Repeated factors
+    GF2Poly repeated = GF2Poly(3).pow(5) * GF2Poly(7).pow(3) * GF2Poly(0x13).pow(2);
+    factors = repeated.factor();
+    text.str("");
+    GF2Poly::write(text, factors);
+    TS_ASSERT(text.str() == "(X + 1)^5 (X^2 + X + 1)^3 (X^4 + X + 1)^2");
+    TS_ASSERT(GF2Poly(1).factor().empty());
+    TS_ASSERT_THROWS(GF2Poly().factor(), std::logic_error);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testHDLC()
+{
+    std::cout << "Testing HDLC framing...";
+
+    size_t const chunks[] = { 1, 7, 100, 100000 };
+
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i)
+    {
+        TS_ASSERT(checkHDLC(CRC<Poly16N>(0x8408), chunks[i]));
+        TS_ASSERT(checkHDLC(CRC<Poly32N>(0xEDB88320), chunks[i]));
+    }
+
+    // RFC 1662, appendix C: with the receive map of LCP, only flags and escapes are escaped
+    CRC<Poly16N> CRC_CCITT(0x8408);
+    HDLCEncoder<Poly16N> encoder(CRC_CCITT, 0);
+    uint8_t const frame[] = { 0xFF, 0x03, 0x7E, 0x01 };
+    uint8_t encoded[32];
+    size_t size = encoder.encode(frame, sizeof(frame), encoded);
+    TS_ASSERT(size >= 9 && encoded[0] == 0x7E && encoded[3] == 0x7D && encoded[4] == 0x5E && encoded[5] == 0x01);
+
+    HDLCDecoder<Poly16N> decoder(CRC_CCITT);
+    TS_ASSERT(decoder.next(encoded, size) == size);
+    TS_ASSERT(decoder.good() && decoder.size() == sizeof(frame) && std::memcmp(decoder.frame(), frame, sizeof(frame)) == 0);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testCellDelineation()
+{
+    std::cout << "Testing cell delineation...";
+
+    typedef CellDelineator<Poly8N> Delineator;
+    CRC<Poly8N> CRC8(0xE0);
+    CRCStream<Poly8N> hec(CRC8, 0, 0x55);
+
+    // Cells with random headers and payloads, after 17 bytes of noise
+    ByteString data = randomData(200 * Delineator::cellSize, 37);
+    ByteString line = randomData(17, 41);
+    std::vector<ByteString> cells;
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        ByteString cell = data.substr(i * Delineator::cellSize, Delineator::headerSize - 1);
+        cell = cell + hec.gen(cell);
+        cell += data.substr(i * Delineator::cellSize + Delineator::headerSize, Delineator::cellSize - Delineator::headerSize);
+        cells.push_back(cell);
+    }
+
+    // Cell 20: a single bit error, which is corrected. Cell 21: another one, discarded in detection mode.
+    // Cells 40 to 46: seven bad headers in a row, which lose the cell boundaries.
+    std::vector<ByteString> damaged = cells;
+    damaged[20][1] ^= 0x10;
+    damaged[21][3] ^= 0x01;
+
+    for (size_t i = 40; i < 47; ++i)
+    {
+        damaged[i][4] ^= 0x03;
+    }
+
+    for (size_t i = 0; i < damaged.size(); ++i)
+    {
+        line += damaged[i];
+    }
+
+    Delineator delineator(CRC8);
+    std::vector<size_t> delivered;
+    bool ok = true;
+
+    for (size_t offset = 0; offset < line.size(); offset += 100)
+    {
+        uint8_t const* pos = line.data() + offset;
+        size_t len = std::min<size_t>(100, line.size() - offset);
+
+        for (size_t n; (n = delineator.next(pos, len)) != 0; pos += n, len -= n)
+        {
+            // Find the cell by its payload
+            size_t i = 0;
+
+            while (i < cells.size() && std::memcmp(cells[i].data() + Delineator::headerSize,
+                                                   delineator.cell() + Delineator::headerSize,
+                                                   Delineator::cellSize - Delineator::headerSize) != 0)
+            {
+                ++i;
+            }
+
+            ok = ok && i < cells.size() && std::memcmp(cells[i].data(), delineator.cell(), Delineator::cellSize) == 0;
+            ok = ok && delineator.correctedBits() == (i == 20 ? 1U : 0U);
+            delivered.push_back(i);
+        }
+    }
+
+    TS_ASSERT(ok);
+    TS_ASSERT(delineator.state() == CrcPP::DelineationSync);
+
+    // The first cell found, and delta = 6 more, are not delivered. Neither are the discarded cell, the cells
+    // with bad headers, and the cells after them until SYNC again: the first good header and 6 more.
+    TS_ASSERT(delivered.size() == 200 - 7 - 1 - 7 - 7);
+    TS_ASSERT(!delivered.empty() && delivered.front() == 7 && delivered.back() == 199);
+    TS_ASSERT(std::find(delivered.begin(), delivered.end(), 21) == delivered.end());
+    TS_ASSERT(std::find(delivered.begin(), delivered.end(), 39) != delivered.end());
+    TS_ASSERT(std::find(delivered.begin(), delivered.end(), 53) == delivered.end());
+    TS_ASSERT(std::find(delivered.begin(), delivered.end(), 54) != delivered.end());
+
+    Delineator::Counters const& counters = delineator.counters();
+    TS_ASSERT(counters.cells == delivered.size() && counters.corrected == 1);
+    TS_ASSERT(counters.discarded == 1 + 6 && counters.syncLosses == 1);
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testKernelTuner()
+{
+    std::cout << "Testing kernel tuner...";
+
+    TS_ASSERT(CrcPP::sizeClass(0) == 0 && CrcPP::sizeClass(15) == 0 && CrcPP::sizeClass(16) == 1);
+    TS_ASSERT(CrcPP::sizeClass(4095) == 4 && CrcPP::sizeClass(4096) == 5 && CrcPP::sizeClass(~static_cast<size_t>(0)) == 5);
+
+    // A different kernel for each size class
+    CRC<Poly32N> reference(0xEDB88320, CrcPP::KernelTable);
+    CRC<Poly32N> algorithm(0xEDB88320, CrcPP::TablesSlicing8);
+    CrcPP::Kernel const kernels[CrcPP::numSizeClasses] =
+        { CrcPP::KernelTable, CrcPP::KernelSlicing, CrcPP::KernelSparse, CrcPP::KernelTable, CrcPP::KernelSparse, CrcPP::KernelSlicing };
+    algorithm.setKernels(kernels);
+    ByteString data = randomData(6000, 43);
+    bool ok = algorithm.kernel() == CrcPP::KernelSlicing && algorithm.kernel(100) == CrcPP::KernelSparse;
+
+    for (size_t len = 0; len <= 5000; len += (len < 300 ? 1 : 61))
+    {
+        Poly32N expected = ~0;
+        Poly32N reg = ~0;
+        reference.add(data.data(), len, expected);
+        algorithm.add(data.data(), len, reg);
+        ok = ok && reg == expected && algorithm.kernel(len) == kernels[CrcPP::sizeClass(len)];
+    }
+
+    TS_ASSERT(ok);
+
+    algorithm.setKernel(CrcPP::KernelTable);
+    TS_ASSERT(algorithm.kernel(100) == CrcPP::KernelTable);
+
+    CrcPP::Kernel const unsupported[CrcPP::numSizeClasses] =
+        { CrcPP::KernelWord, CrcPP::KernelSlicing, CrcPP::KernelSlicing, CrcPP::KernelSlicing, CrcPP::KernelSlicing, CrcPP::KernelSlicing };
+    TS_ASSERT_THROWS(algorithm.setKernels(unsupported), std::runtime_error);
+    TS_ASSERT(algorithm.kernel(100) == CrcPP::KernelTable);
+
+    // Tune CRC-CCITT, and load the result from the cache
+    if (std::getenv("CRCPP_KERNEL") == 0)
+    {
+        // A cache of its own, in a fresh temporary directory
+        char const* tmp = std::getenv("TMPDIR");
+        std::string dir = std::string(tmp != 0 && *tmp != 0 ? tmp : "/tmp") + "/crctune-XXXXXX";
+        TS_ASSERT(mkdtemp(&dir[0]) != 0);
+        std::string path = dir + "/test.tune";
+
+        CRC<Poly16N> ccitt(0x8408);
+        CrcPP::KernelTuner tuner(path);
+        CrcPP::KernelTuner::Tuning tuning;
+        TS_ASSERT(!tuner.apply(ccitt));
+        tuner.tune(ccitt);
+        TS_ASSERT(tuner.find(Poly16N(0x8408), ccitt.tables(), tuning));
+
+        CRC<Poly16N> cached(0x8408);
+        CrcPP::KernelTuner loaded(path);
+        TS_ASSERT(loaded.apply(cached));
+        ok = true;
+
+        for (size_t c = 0; c < CrcPP::numSizeClasses; ++c)
+        {
+            ok = ok && tuning.choices[c].kernel == ccitt.kernel((static_cast<size_t>(1) << (2 * c + 4)) - 1);
+            ok = ok && tuning.choices[c].kernel == cached.kernel((static_cast<size_t>(1) << (2 * c + 4)) - 1);
+            ok = ok && tuning.choices[c].speed > 0;
+        }
+
+        CRC<Poly16N> plain(0x8408, CrcPP::KernelTable);
+        Poly16N expected = ~0;
+        Poly16N reg = ~0;
+        plain.add(data.data(), data.size(), expected);
+        cached.add(data.data(), data.size(), reg);
+        TS_ASSERT(ok && reg == expected);
+
+        loaded.forget(Poly16N(0x8408));
+        TS_ASSERT(!loaded.find(Poly16N(0x8408), ccitt.tables(), tuning));
+        std::remove(path.c_str());
+        TS_ASSERT(rmdir(dir.c_str()) == 0);
+    }
+
+    std::cout << "OK." << std::endl;
+}
+
+void CRCTest::testMetrics()
+{
+    std::cout << "Testing metrics...";
+
+    TS_ASSERT(CrcPP::CRCMetrics::sizeBucket(16) == 0 && CrcPP::CRCMetrics::sizeBucket(17) == 1);
+    TS_ASSERT(CrcPP::CRCMetrics::sizeBucket(~static_cast<size_t>(0)) == CrcPP::CRCMetrics::numSizeBuckets - 1);
+    TS_ASSERT(CrcPP::CRCMetrics::latencyBucket(64) == 0 && CrcPP::CRCMetrics::latencyBucket(65) == 1);
+
+    CRC<Poly32N> algorithm(0xEDB88320, CrcPP::TablesSlicing8, CrcPP::KernelSlicing);
+    CRCStream<Poly32N> stream(algorithm);
+    CrcPP::CRCMetrics::Algorithm a = CrcPP::CRCMetrics::algorithm(Poly32N(0xEDB88320));
+    CrcPP::CRCMetrics::setName(a, "ieee802.3");
+    CrcPP::CRCMetrics::Snapshot before = CrcPP::CRCMetrics::snapshot();
+
+    CrcPP::CRCMetrics::enable();
+    ByteString data = randomData(5000, 47);
+    uint8_t block[12] = { 0 };
+    Poly32N reg = 0;
+    algorithm.add(data.data(), 10, reg);
+    algorithm.add(data.data(), 5000, reg);
+    algorithm.add(block, reg);
+
+    // Counts of threads which have ended are kept
+    std::thread thread([&algorithm, &data]()
+    {
+        Poly32N reg = 0;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            algorithm.add(data.data(), 100, reg);
+        }
+    });
+    thread.join();
+
+    ByteString message = data.substr(0, 100);
+    message = message + stream.gen(message);
+    TS_ASSERT(stream.check(message));
+    message[7] ^= 1;
+    TS_ASSERT(!stream.check(message));
+    CrcPP::CRCMetrics::enable(false);
+    algorithm.add(data.data(), 10, reg);
+
+    CrcPP::CRCMetrics::Snapshot after = CrcPP::CRCMetrics::snapshot();
+    CrcPP::CRCMetrics::AlgorithmCounts const& was = before[a];
+    CrcPP::CRCMetrics::AlgorithmCounts const& now = after[a];
+    CrcPP::CRCMetrics::Counts const& slicingWas = was.kernels[CrcPP::KernelSlicing];
+    CrcPP::CRCMetrics::Counts const& slicing = now.kernels[CrcPP::KernelSlicing];
+    uint64_t timed = 0;
+
+    for (size_t b = 0; b < CrcPP::CRCMetrics::numLatencyBuckets; ++b)
+    {
+        timed += slicing.latencies[b] - slicingWas.latencies[b];
+    }
+
+    // The CRCStream adds the message in one go: once for gen(), twice for check()
+    TS_ASSERT(slicing.calls - slicingWas.calls == 9 && slicing.bytes - slicingWas.bytes == 10 + 5000 + 12 + 300 + 100 + 2 * 104);
+    TS_ASSERT(slicing.sizes[0] - slicingWas.sizes[0] == 2 && slicing.sizes[2] - slicingWas.sizes[2] == 6);
+    TS_ASSERT(slicing.sizes[5] - slicingWas.sizes[5] == 1 && timed <= 9);
+    TS_ASSERT(now.good - was.good == 1 && now.bad - was.bad == 1 && now.name == "ieee802.3");
+
+    std::ostringstream prometheus;
+    CrcPP::MetricsWriter::writePrometheus(prometheus, after);
+    TS_ASSERT(prometheus.str().find("crcpp_bytes_total{algorithm=\"ieee802.3\",kernel=\"slicing\"} ") != std::string::npos);
+    TS_ASSERT(prometheus.str().find("crcpp_message_size_bytes_bucket{algorithm=\"ieee802.3\",kernel=\"slicing\",le=\"+Inf\"} ") != std::string::npos);
+    TS_ASSERT(prometheus.str().find("crcpp_checks_total{algorithm=\"ieee802.3\",result=\"bad\"} ") != std::string::npos);
+
+    std::ostringstream json;
+    CrcPP::MetricsWriter::writeJSON(json, after);
+    TS_ASSERT(json.str().find("\"algorithm\": \"ieee802.3\"") != std::string::npos);
+    TS_ASSERT(json.str().find("{ \"kernel\": \"slicing\", \"bytes\": ") != std::string::npos);
+
+    // A forced kernel also adds fixed length data and several buffers, even where the crc32 instruction could
+    CRC<Poly32N> forced(0x82F63B78, CrcPP::KernelTable);
+    CRC<Poly32N> automatic(0x82F63B78);
+    CrcPP::CRCMetrics::Algorithm castagnoli = CrcPP::CRCMetrics::algorithm(Poly32N(0x82F63B78));
+    uint8_t const* buffers[] = { data.data(), data.data() + 100, data.data() + 200, data.data() + 300, data.data() + 400 };
+    size_t const lengths[] = { 100, 100, 100, 100, 1000 };
+    Poly32N regs[5] = { 0, 0, 0, 0, 0 };
+    Poly32N expected[5] = { 0, 0, 0, 0, 0 };
+    Poly32N fixed = 0;
+    Poly32N fixedExpected = 0;
+
+    before = CrcPP::CRCMetrics::snapshot();
+    CrcPP::CRCMetrics::enable();
+    forced.add(block, fixed);
+    forced.add(buffers, lengths, regs, 5);
+    CrcPP::CRCMetrics::enable(false);
+    after = CrcPP::CRCMetrics::snapshot();
+
+    automatic.add(block, fixedExpected);
+    automatic.add(buffers, lengths, expected, 5);
+    TS_ASSERT(forced.kernel() == CrcPP::KernelTable && fixed == fixedExpected);
+    TS_ASSERT(std::equal(regs, regs + 5, expected));
+
+    for (int k = 0; k < CrcPP::numKernels; ++k)
+    {
+        uint64_t calls = after[castagnoli].kernels[k].calls - before[castagnoli].kernels[k].calls;
+        TS_ASSERT(calls == (k == CrcPP::KernelTable ? 6U : 0U));
+    }
+
+    std::cout << "OK." << std::endl;
+}
@@ -89,4 +89,137 @@ public:
      * Test CAN CRC_15 described in ISO 11898-1:2015(E)
      */
     static void testCanCrC15();
+
+    /**
+     * @brief Test rolling CRC
+     *
+     * Compares the rolling CRC with the CRC of the window computed from scratch
+     */
+    static void testRolling();
+
+    /**
+     * @brief Test content defined chunking
+     *
+     * Chunk boundaries must not depend on how the data is split into buffers
+     */
+    static void testChunker();
+
+    /**
+     * @brief Test appending runs of zero or constant bytes
+     *
+     * Compares the O(log n) implementation with adding the bytes one by one,
+     * and combining the CRCs of blocks with adding the blocks
+     */
+    static void testZeros();
+
+    /**
+     * @brief Test CRC forcing
+     *
+     * Overwriting bytes to reach a wanted CRC at several offsets, updating a CRC after a change,
+     * and removing zero bytes again
+     */
+    static void testForce();
+
+    /**
+     * @brief Test scatter/gather input
+     *
+     * A message split into fragments must give the same CRC as the contiguous message
+     */
+    static void testScatterGather();
+
+    /**
+     * @brief Test the checksumming stream buffer
+     *
+     * Data written to and read from iostreams must be checksummed on the fly
+     */
+    static void testStreamBuffer();
+
+    /**
+     * @brief Test the fused copy and CRC kernel
+     *
+     * Small and large (streaming) copies to unaligned destinations
+     */
+    static void testCopyAndAdd();
+
+    /**
+     * @brief Test exporting and importing the state of a calculation
+     *
+     * A calculation continued from an exported state gives the same result,
+     * and a state of another algorithm is rejected
+     */
+    static void testState();
+
+    /**
+     * @brief Test the bulk kernels
+     *
+     * All kernels supported on the CPU against the table kernel, for several polynomials,
+     * lengths and alignments, one buffer at a time and several in parallel
+     */
+    static void testKernels();
+
+    /**
+     * @brief Test the table size policies
+     *
+     * All table sizes with all kernels they support against the byte table, and invalid table sizes
+     */
+    static void testTables();
+
+    /**
+     * @brief Test error correction
+     *
+     * Single bit errors in ATM cell headers, single and double bit errors in CRC-CCITT frames
+     */
+    static void testCorrection();
+
+    /**
+     * @brief Test the hash function object
+     *
+     * Check values, use in a hash table, and hashing columns of keys against hashing single keys
+     */
+    static void testHash();
+
+    /**
+     * @brief Test the batch verifier
+     *
+     * Batches of messages of two algorithms, some damaged, verified from several threads at once
+     */
+    static void testBatchVerifier();
+
+    /**
+     * @brief Test the polynomial arithmetic
+     *
+     * Products and division, powers, factorisation of known generators, and irreducible and primitive polynomials
+     */
+    static void testPolynomials();
+
+    /**
+     * @brief Test HDLC framing
+     *
+     * Frames encoded with FCS-16 and FCS-32 decode to the original frames, whatever the chunks the
+     * decoder gets; damaged, aborted, short and long frames are reported
+     */
+    static void testHDLC();
+
+    /**
+     * @brief Test ATM cell delineation
+     *
+     * Finding the cell boundaries at an odd offset, correcting and discarding cells with damaged headers,
+     * and losing and finding the boundaries again
+     */
+    static void testCellDelineation();
+
+    /**
+     * @brief Test the selection of kernels by size, and the kernel tuner
+     *
+     * Different kernels for each size class against the table kernel, and tuning results which
+     * survive saving and loading the cache
+     */
+    static void testKernelTuner();
+
+    /**
+     * @brief Test the runtime metrics
+     *
+     * Bytes, calls, sizes and results counted in two threads, and their export
+     */
+    static void testMetrics();
 };
@@ -22,6 +22,15 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 /**
  * @file crc.h
@@ -36,6 +45,25 @@
 #  define uint8_t  UINT8
 #else
 #  include <stdint.h>   // uintxx_t types
+#  include <sys/uio.h>  // struct iovec
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>  // non-temporal stores
+#  define CRCPP_HAVE_SSE2 1
+#endif
+
+// Kernels using instruction set extensions are compiled for their target only and selected at runtime
+#if defined (__x86_64__) || defined (_M_X64)
+#  define CRCPP_HAVE_X86_KERNELS 1
+#  include <immintrin.h>
+#  if defined (_MSC_VER)
+#    include <intrin.h>
+#    define CRCPP_TARGET(features)
+#  else
+#    include <cpuid.h>
+#    define CRCPP_TARGET(features) __attribute__((target(features)))
+#  endif
 #endif
 
 namespace CrcPP
@@ -50,6 +78,7 @@ namespace CrcPP
     public:
         typedef T   data_type;
         static unsigned int const numbits = bitsize;
+        static bool const reflected = true;
         PolyN(T v = 0) : value(v) {}
 
         /**
@@ -76,6 +105,14 @@ namespace CrcPP
         {
             value = data ;
         }
+        /**
+         * The polynomial 1 (only coefficient X^0 set).
+         * @return the polynomial 1 in network order
+         */
+        static PolyN one()
+        {
+            return PolyN(static_cast<T>(static_cast<T>(1) << (bitsize - 1)));
+        }
         T shift(int n) const
         {
             return value >> n;
@@ -95,6 +132,7 @@ namespace CrcPP
     public:
         typedef T   data_type;
         static unsigned int const numbits = bitsize;
+        static bool const reflected = false;
         Poly(T v = 0) : value(v) {}
 
         /**
@@ -123,6 +161,14 @@ namespace CrcPP
             // See http://en.cppreference.com/w/cpp/language/implicit_cast
             value = static_cast<T>(static_cast<T>(data) << (bitsize - 8));      // Needed for table generation
         }
+        /**
+         * The polynomial 1 (only coefficient X^0 set).
+         * @return the polynomial 1 in native order
+         */
+        static Poly one()
+        {
+            return Poly(1);
+        }
         T shift(int n) const
         {
             return static_cast<T>(value << n);
@@ -141,9 +187,273 @@ namespace CrcPP
     typedef Poly<uint16_t> Poly16;
     typedef Poly<uint8_t> Poly8;
 
+    /**
+     * The implementations of the bulk CRC calculation, see CRC::setKernel()
+     * @ingroup CRCpp
+     */
+
+    enum Kernel
+    {
+        KernelAuto,         ///< The fastest kernel supported by the CPU, the polynomial and the tables
+        KernelTable,        ///< One table lookup per byte, or per nibble or bit, depending on the tables
+        KernelSlicing,      ///< Slicing by 4, 8 or 16: independent table lookups for each byte of a block
+        KernelWord,         ///< One table lookup per 16 bits
+        KernelCLMul,        ///< Folding 512 bits at a time with carry-less multiplication (PCLMULQDQ)
+        KernelVPCLMul,      ///< Folding 1024 bits at a time with 256 bit carry-less multiplication (AVX2, VPCLMULQDQ)
+        KernelCRC32C,       ///< The crc32 instruction of SSE4.2. Only for CRC-32C (Castagnoli).
+        KernelSparse,       ///< No tables and no special instructions: a word XOR for each coefficient of the generator
+        numKernels
+    };
+
+    /**
+     * The lookup tables computed by a CRC. Larger tables allow faster kernels, but take more
+     * memory and cache. Copies of a CRC (also those in a CRCStream) share the tables.
+     * @ingroup CRCpp
+     */
+
+    enum Tables
+    {
+        TablesNone,         ///< No tables: bit by bit, or carry-less multiplication where available
+        TablesNibble,       ///< 16 entries, two lookups per byte
+        TablesByte,         ///< 256 entries, one lookup per byte
+        TablesSlicing4,     ///< 4 x 256 entries for slicing by 4. Polynomials of up to 32 bits only.
+        TablesSlicing8,     ///< 8 x 256 entries for slicing by 8
+        TablesSlicing16,    ///< 16 x 256 entries for slicing by 16
+        TablesWord          ///< 256 + 65536 entries, one lookup per 16 bits. Polynomials of 16 bits or more only.
+    };
+
+    /**
+     * The name of a kernel, as used by the environment variable CRCPP_KERNEL
+     * @ingroup CRCpp
+     * @param kernel the kernel
+     * @return the name of the kernel
+     */
+    inline char const* kernelName(Kernel kernel)
+    {
+        static char const* const names[numKernels] = { "auto", "table", "slicing", "word", "clmul", "vpclmul", "crc32c", "sparse" };
+        return kernel < numKernels ? names[kernel] : "unknown";
+    }
+
+    /**
+     * Look up a kernel by name
+     * @ingroup CRCpp
+     * @param name the name of the kernel, may be 0
+     * @return the kernel, or KernelAuto if the name is unknown
+     */
+    inline Kernel kernelFromName(char const* name)
+    {
+        for (int kernel = KernelAuto; name != 0 && kernel < numKernels; ++kernel)
+        {
+            if (std::strcmp(name, kernelName(static_cast<Kernel>(kernel))) == 0)
+            {
+                return static_cast<Kernel>(kernel);
+            }
+        }
+
+        return KernelAuto;
+    }
+
+    /**
+     * The number of size classes of data, for which CRC::setKernels() selects kernels
+     * @ingroup CRCpp
+     */
+    size_t const numSizeClasses = 6;
+
+    /**
+     * The size class of data: class c holds data of less than 16 * 4^c bytes, except for the last class,
+     * which holds all longer data. The classes end at 16, 64, 256, 1K and 4K bytes.
+     * @ingroup CRCpp
+     * @param len the number of bytes
+     * @return the size class
+     */
+    inline size_t sizeClass(size_t len)
+    {
+        size_t c = 0;
+
+        for (size_t limit = 16; c + 1 < numSizeClasses && len >= limit; limit *= 4)
+        {
+            ++c;
+        }
+
+        return c;
+    }
+
+    /**
+     * The instruction set extensions of the CPU the program runs on
+     * @ingroup CRCpp
+     */
+
+    class CPUFeatures
+    {
+    public:
+        bool ssse3;
+        bool sse42;
+        bool pclmul;
+        bool avx2;
+        bool vpclmul;
+        std::string model;      ///< the brand string of the CPU, empty if unknown
+
+        /**
+         * The features are probed once, on first use.
+         * @return the features of this CPU
+         */
+        static CPUFeatures const& get()
+        {
+            static CPUFeatures const features;
+            return features;
+        }
+
+    private:
+        CPUFeatures() :
+            ssse3(false),
+            sse42(false),
+            pclmul(false),
+            avx2(false),
+            vpclmul(false)
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            unsigned int regs[4];      // eax, ebx, ecx, edx
+            cpuid(0, regs);
+            unsigned int maxLeaf = regs[0];
+
+            cpuid(1, regs);
+            ssse3  = (regs[2] & (1U << 9)) != 0;
+            sse42  = (regs[2] & (1U << 20)) != 0;
+            pclmul = (regs[2] & (1U << 1)) != 0;
+
+            // AVX registers can only be used if the operating system saves them
+            bool ymm = (regs[2] & (1U << 27)) != 0 && (regs[2] & (1U << 28)) != 0 && (xgetbv() & 6) == 6;
+
+            if (maxLeaf >= 7)
+            {
+                cpuid(7, regs);
+                avx2    = ymm && (regs[1] & (1U << 5)) != 0;
+                vpclmul = ymm && (regs[2] & (1U << 10)) != 0;
+            }
+
+            // The brand string, 16 characters in each of three leaves
+            cpuid(0x80000000U, regs);
+
+            if (regs[0] >= 0x80000004U)
+            {
+                char brand[49] = { 0 };
+
+                for (unsigned int i = 0; i < 3; ++i)
+                {
+                    cpuid(0x80000002U + i, regs);
+                    std::memcpy(brand + 16 * i, regs, 16);
+                }
+
+                model = brand;
+                model.erase(0, model.find_first_not_of(' '));
+            }
+#endif
+        }
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+        static void cpuid(unsigned int leaf, unsigned int regs[4])
+        {
+#  if defined (_MSC_VER)
+            int r[4];
+            __cpuidex(r, leaf, 0);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                regs[i] = static_cast<unsigned int>(r[i]);
+            }
+#  else
+            __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#  endif
+        }
+
+        static uint64_t xgetbv()
+        {
+#  if defined (_MSC_VER)
+            return _xgetbv(0);
+#  else
+            uint32_t eax, edx;
+            __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#  endif
+        }
+
+#endif
+    };
+
+    /**
+     * The hook through which CRC and CRCStream report to the runtime metrics
+     * @ingroup CRCpp
+     *
+     * The metrics themselves and their export are in crcmetrics.h (see CRCMetrics), so programs which do not
+     * use them do not carry them. While no hook is installed, a call costs one load of a pointer and a branch.
+     */
+    class MetricsHook
+    {
+    public:
+        /// The start or latency of a call which is not timed
+        static uint64_t const untimed = ~static_cast<uint64_t>(0);
+
+        virtual ~MetricsHook()
+        {
+        }
+
+        /// @return the start of a call in nanoseconds, or untimed if the call is not in the sample
+        virtual uint64_t start() = 0;
+
+        /// @return the nanoseconds since start, or untimed
+        virtual uint64_t elapsed(uint64_t start) = 0;
+
+        /**
+         * Record a call
+         * @param generator   the generator polynomial
+         * @param bits        the width of the CRC
+         * @param reflected   whether the CRC is in network bit order
+         * @param kernel      the kernel
+         * @param len         the number of bytes
+         * @param nanoseconds the latency, or untimed
+         */
+        virtual void record(uint64_t generator, unsigned int bits, bool reflected, Kernel kernel, size_t len, uint64_t nanoseconds) = 0;
+
+        /**
+         * Record the result of checking a CRC
+         * @param generator the generator polynomial
+         * @param bits      the width of the CRC
+         * @param reflected whether the CRC is in network bit order
+         * @param good      whether the CRC is good
+         */
+        virtual void recordResult(uint64_t generator, unsigned int bits, bool reflected, bool good) = 0;
+
+        /// @return the installed hook, null if metrics are off
+        static MetricsHook* get()
+        {
+            return current().load(std::memory_order_acquire);
+        }
+
+        /**
+         * Install a hook
+         * @param hook the hook, null to turn metrics off. It must live as long as it is installed.
+         */
+        static void set(MetricsHook* hook)
+        {
+            current().store(hook, std::memory_order_release);
+        }
+
+    private:
+        static std::atomic<MetricsHook*>& current()
+        {
+            static std::atomic<MetricsHook*> hook(0);
+            return hook;
+        }
+    };
+
     /**
      * The CRC implementation
      * @ingroup CRCpp
+     *
+     * Bulk data is added by one of several kernels, which is selected when the CRC is constructed.
+     * By default, this is the fastest kernel which the CPU and the polynomial support, unless
+     * the environment variable CRCPP_KERNEL names another supported kernel (see kernelName()).
      */
 
     template <class P> class CRC
@@ -153,28 +463,218 @@ namespace CrcPP
         /**
          * Constructor.
          * @param generator   The generator polynomial
+         * @param tables      The lookup tables to compute. Slicing and word tables need a polynomial
+         *                    which fills its data type. The default is a byte table.
+         * @param kernel      The kernel for bulk data, see setKernel()
          */
-        CRC(P const generator) :
-            _generator(generator)
+        CRC(P const generator, Tables tables = defaultTables(), Kernel kernel = KernelAuto) :
+            _generator(generator),
+            _tables(tables),
+            _table(0),
+            _byte(&addByteSmall),
+            _nibbles(0),
+            _slices(0),
+            _words(0),
+            _numSparse(0),
+            _barrett(0)
         {
             if (!generator.lobit())
             {
                 throw std::logic_error("Coefficient X^0 of the generator polynomial must be 1");
             }
 
-            for (unsigned int index = 0; index < 256; index++)
+            if (tables > TablesByte && !fullWidth)
+            {
+                throw std::logic_error("Slicing and word tables need a polynomial which fills its data type");
+            }
+
+            if ((tables == TablesSlicing4 && P::numbits > 32) || (tables == TablesWord && P::numbits < 16))
+            {
+                throw std::logic_error("Table size does not fit the size of the polynomial");
+            }
+
+            buildTables();
+
+            // Multipliers for appending 2^k zero bytes: X^(8*2^k) mod G
+            _zeros[0] = P::one();
+            add(0, _zeros[0]);
+
+            for (unsigned int k = 1; k < numZeros; ++k)
+            {
+                _zeros[k] = multiply(_zeros[k - 1], _zeros[k - 1]);
+            }
+
+            // Constants for folding 128 << k bits with carry-less multiplication
+            if (fullWidth)
+            {
+                for (unsigned int k = 0; k < numFolds; ++k)
+                {
+                    unsigned int distance = 128U << k;
+
+                    if (P::reflected)
+                    {
+                        _fold[k][0] = foldConstant(distance + 63);
+                        _fold[k][1] = foldConstant(distance - 1);
+                    }
+                    else
+                    {
+                        _fold[k][0] = foldConstant(distance);
+                        _fold[k][1] = foldConstant(distance + 64);
+                    }
+                }
+
+                _barrett = barrettConstant();
+
+                // The distances of the sparse kernel: X^(64n) = sum of X^(64i) for the coefficients X^i of G - X^n
+                for (unsigned int i = 0; i < P::numbits; ++i)
+                {
+                    unsigned int bit = P::reflected ? P::numbits - 1 - i : i;
+
+                    if ((static_cast<data_type>(_generator) >> bit) & 1)
+                    {
+                        _sparse[_numSparse++] = static_cast<uint8_t>(P::numbits - i);
+                    }
+                }
+            }
+
+            setKernel(kernel);
+        }
+
+        /**
+         * Constructor with the default tables.
+         * @param generator   The generator polynomial
+         * @param kernel      The kernel for bulk data, see setKernel()
+         */
+        CRC(P const generator, Kernel kernel) :
+            CRC(generator, defaultTables(), kernel)
+        {
+        }
+
+        /**
+         * Select the kernel for bulk data.
+         * @param kernel the kernel. KernelAuto selects the kernel named by the environment variable
+         *               CRCPP_KERNEL if it is supported, and the fastest supported kernel otherwise.
+         * @throw std::runtime_error if the kernel is not supported by the CPU, the polynomial or the tables
+         */
+        void setKernel(Kernel kernel)
+        {
+            // Unless a kernel is forced, the crc32 instruction also adds short and fixed length data
+            bool automatic = kernel == KernelAuto && forcedKernel() == KernelAuto;
+            kernel = select(kernel);
+            _bulk = bulkKernel(kernel);
+
+            for (size_t i = 0; i < numSizeClasses; ++i)
+            {
+                _kernels[i] = kernel;
+                _bySize[i] = _bulk;
+            }
+
+            _kernel = kernel;
+            setSmallKernels(kernel == KernelCRC32C || (automatic && supports(KernelCRC32C)));
+        }
+
+        /**
+         * Select a kernel for each size class of data, e.g. as measured by KernelTuner.
+         * The kernel of the last class, for the longest data, is the one returned by kernel().
+         * @param kernels the kernel for each size class, see sizeClass(). KernelAuto as for setKernel().
+         * @throw std::runtime_error if a kernel is not supported by the CPU, the polynomial or the tables
+         */
+        void setKernels(Kernel const (&kernels)[numSizeClasses])
+        {
+            Kernel selected[numSizeClasses];
+
+            for (size_t i = 0; i < numSizeClasses; ++i)
+            {
+                selected[i] = select(kernels[i]);
+            }
+
+            setKernel(selected[numSizeClasses - 1]);
+
+            for (size_t i = 0; i < numSizeClasses; ++i)
             {
-                P crc;
-                crc.sethibyte(static_cast<uint8_t>(index));
+                _kernels[i] = selected[i];
+                _bySize[i] = bulkKernel(selected[i]);
 
-                for (int bit = 0; bit < 8; bit++)
+                if (selected[i] != _kernel)
                 {
-                    crc = crc.hibit() ? (crc.shift(1) ^ generator) : crc.shift(1);
+                    _bulk = &addBySize;
                 }
 
-                _table[ index ] = crc;
+                // Short and fixed length data go with the kernel selected for short data
+                if (selected[i] == KernelCRC32C)
+                {
+                    setSmallKernels(true);
+                }
             }
+        }
+
+        /// @return the kernel for bulk data
+        Kernel kernel() const
+        {
+            return _kernel;
+        }
+
+        /**
+         * @param len the number of bytes
+         * @return the kernel which adds len bytes, see setKernels()
+         */
+        Kernel kernel(size_t len) const
+        {
+            return _kernels[sizeClass(len)];
+        }
+
+        /// @return the lookup tables
+        Tables tables() const
+        {
+            return _tables;
+        }
+
+        /// @return the default tables for the polynomial
+        static Tables defaultTables()
+        {
+            return TablesByte;
+        }
+
+        /**
+         * Check if a kernel can be used for this polynomial on this CPU
+         * @param kernel the kernel
+         * @return true if setKernel() accepts the kernel
+         */
+        bool supports(Kernel kernel) const
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            CPUFeatures const& cpu = CPUFeatures::get();
+#endif
+
+            switch (kernel)
+            {
+            case KernelAuto:
+            case KernelTable:
+                return true;
+
+            case KernelSlicing:
+                return _slices != 0;
+
+            case KernelWord:
+                return _words != 0;
 
+            case KernelSparse:
+                return fullWidth;
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            case KernelCLMul:
+                return fullWidth && cpu.pclmul && cpu.ssse3;
+
+            case KernelVPCLMul:
+                return fullWidth && cpu.pclmul && cpu.ssse3 && cpu.avx2 && cpu.vpclmul;
+
+            case KernelCRC32C:
+                return cpu.sse42 && P::reflected && fullWidth && P::numbits == 32 && _generator == 0x82F63B78U;
+#endif
+
+            default:
+                return false;
+            }
         }
 
         /**
@@ -184,7 +684,7 @@ namespace CrcPP
          */
         void add(uint8_t data, P& reg) const
         {
-            reg = reg.shift(8) ^ _table[reg.hibyte() ^ data];
+            _byte(*this, data, reg);
         }
 
         /**
@@ -193,13 +693,43 @@ namespace CrcPP
          * @param len  the number of bytes to add
          * @param reg  the working register
          */
-        void add(uint8_t const* data, unsigned int len, P& reg) const
+        void add(uint8_t const* data, size_t len, P& reg) const
         {
-            while (len > 0)
+            MetricsHook* metrics = MetricsHook::get();
+
+            if (metrics != 0)
             {
-                add(*data++, reg);
-                --len;
+                uint64_t start = metrics->start();
+                _bulk(*this, data, len, reg);
+                record(*metrics, kernel(len), len, metrics->elapsed(start));
+                return;
             }
+
+            _bulk(*this, data, len, reg);
+        }
+
+        /**
+         * Add a block of bytes whose length is known at compile time, such as a cell header or a record.
+         * The loops over the block are unrolled. Up to 16 bytes are added with two carry-less
+         * multiplications per 8 bytes (Barrett reduction) if the kernel is a folding kernel, and
+         * with the crc32 instruction for CRC-32C. Blocks of more than 64 bytes, and blocks of 64 bytes
+         * with a folding kernel, go to the bulk kernel.
+         * @param data the data to add
+         * @param reg  the working register
+         */
+        template <size_t N> void add(uint8_t const (&data)[N], P& reg) const
+        {
+            MetricsHook* metrics = MetricsHook::get();
+
+            if (metrics != 0)
+            {
+                uint64_t start = metrics->start();
+                addBlock(data, reg);
+                record(*metrics, blockKernel(N), N, metrics->elapsed(start));
+                return;
+            }
+
+            addBlock(data, reg);
         }
 
         /**
@@ -226,29 +756,1442 @@ namespace CrcPP
             }
         }
 
-        void addbit(uint8_t bit, P& reg) const
+        /**
+         * Copy bytes and add them to the calculation in the same pass.
+         * The data is copied in small blocks, each of which is added to the CRC while it is still
+         * in the cache, so the source is read from memory only once. Large copies use non-temporal
+         * stores where available, so the destination does not evict the source from the cache.
+         * @param dst  the destination. Must not overlap with src.
+         * @param src  the data to copy and add
+         * @param len  the number of bytes
+         * @param reg  the working register
+         */
+        void copyAndAdd(uint8_t* dst, uint8_t const* src, size_t len, P& reg) const
         {
-            if (bit ^ reg.hibit())
-            {
-                reg = reg.shift(1) ^ _generator;
-            }
-            else
+            MetricsHook* metrics = MetricsHook::get();
+
+            if (metrics != 0)
             {
-                reg = reg.shift(1);
+                uint64_t start = metrics->start();
+                copyBlocks(dst, src, len, reg);
+                record(*metrics, kernel(len < copyBlockSize ? len : copyBlockSize), len, metrics->elapsed(start));
+                return;
             }
+
+            copyBlocks(dst, src, len, reg);
         }
 
-        P generator() const
+#if !defined (WIN32)
+
+        /**
+         * Add bytes from a scatter/gather list to the calculation.
+         * Buffers of at least gatherSize bytes are passed to the bulk add() in place, without a copy.
+         * Consecutive shorter buffers are copied into a small block on the stack and added together,
+         * so chains of small fragments still reach the word and folding kernels instead of being added
+         * bytewise, one head and tail at a time.
+         * @param iov   the buffers, as for writev()
+         * @param count the number of buffers
+         * @param reg   the working register
+         */
+        void add(struct iovec const* iov, size_t count, P& reg) const
         {
-            return _generator;
+            uint8_t gathered[2 * gatherSize];
+            size_t used = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint8_t const* data = static_cast<uint8_t const*>(iov[i].iov_base);
+                size_t len = iov[i].iov_len;
+
+                if (len < gatherSize)
+                {
+                    if (used + len > sizeof(gathered))
+                    {
+                        add(gathered, used, reg);
+                        used = 0;
+                    }
+
+                    std::memcpy(gathered + used, data, len);
+                    used += len;
+                    continue;
+                }
+
+                if (used > 0)
+                {
+                    add(gathered, used, reg);
+                    used = 0;
+                }
+
+                add(data, len, reg);
+            }
+
+            if (used > 0)
+            {
+                add(gathered, used, reg);
+            }
         }
 
-        P const* table() const
+#endif
+
+        /**
+         * Add several independent buffers, each to its own register, as with add(data[i], len[i], reg[i]).
+         * The folding kernels process four buffers at a time in one interleaved loop. A single buffer
+         * needs several hundred bytes to keep the carry-less multiplier busy, four buffers of network
+         * frame size do. Short buffers of CRC-32C, such as hash keys, are interleaved with the crc32
+         * instruction instead. The other kernels add one buffer after the other.
+         * @param data  the buffers
+         * @param len   the number of bytes in each buffer
+         * @param reg   the working registers, one per buffer
+         * @param count the number of buffers
+         */
+        void add(uint8_t const* const* data, size_t const* len, P* reg, size_t count) const
+        {
+            MetricsHook* metrics = MetricsHook::get();
+
+            if (metrics != 0 && count > 0)
+            {
+                uint64_t start = metrics->start();
+                addBuffers(data, len, reg, count);
+                uint64_t elapsed = metrics->elapsed(start);
+                uint64_t share = elapsed == MetricsHook::untimed ? elapsed : elapsed / count;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    record(*metrics, bufferKernel(i, count, len[i]), len[i], share);
+                }
+
+                return;
+            }
+
+            addBuffers(data, len, reg, count);
+        }
+
+        /**
+         * Add a sequence of zero bytes to the calculation.
+         * Adding n zero bytes multiplies the register with X^(8n) mod G. This is done with
+         * the precomputed multipliers for 2^k zero bytes, so the time is O(log n) instead of O(n).
+         * @param n   the number of zero bytes to add
+         * @param reg the working register
+         */
+        void addZeros(size_t n, P& reg) const
+        {
+            for (unsigned int k = 0; n != 0; ++k, n >>= 1)
+            {
+                if (n & 1)
+                {
+                    reg = multiply(reg, _zeros[k]);
+                }
+            }
+        }
+
+        /**
+         * Combine the registers of two consecutive pieces of data in O(log n).
+         * Since the CRC is linear, the register after adding both pieces is the register after the first piece,
+         * followed by as many zero bytes as the second piece has, plus the register of the second piece alone.
+         * So the pieces can be added independently, for example in parallel.
+         * @param first  the register after adding the first piece
+         * @param second the register after adding the second piece to a zero register
+         * @param len    the number of bytes in the second piece
+         * @return the register after adding both pieces
+         */
+        P combine(P first, P const& second, size_t len) const
+        {
+            addZeros(len, first);
+            return first ^ second;
+        }
+
+        /**
+         * Remove a sequence of zero bytes from the end of the calculation, undoing addZeros().
+         * Since G has the coefficient X^0, X has an inverse modulo G. Removing n zero bytes
+         * multiplies the register with X^(-8n) mod G, with O(log n) multiplications.
+         * @param n   the number of zero bytes to remove
+         * @param reg the working register
+         */
+        void removeZeros(size_t n, P& reg) const
+        {
+            // X^-8: a register, shifted back by 8 bits
+            P inverse = P::one();
+
+            for (unsigned int bit = 0; bit < 8; ++bit)
+            {
+                inverse = unshift(inverse);
+            }
+
+            for (; n != 0; n >>= 1)
+            {
+                if (n & 1)
+                {
+                    reg = multiply(reg, inverse);
+                }
+
+                if (n > 1)
+                {
+                    inverse = multiply(inverse, inverse);
+                }
+            }
+        }
+
+        /**
+         * Update the CRC of data after a part of it was changed, without adding the data again.
+         * The CRC changes by the CRC of the difference of the old and the new bytes, from a zero register,
+         * followed by the bytes after them. This takes O(len + log following).
+         * Preset and invert do not matter, as long as crc was computed with the same ones.
+         * @param crc       the CRC of the data with the old bytes, or the register after adding it
+         * @param oldData   the old bytes
+         * @param newData   the new bytes
+         * @param len       the number of bytes changed
+         * @param following the number of bytes in the data after the changed ones
+         * @return the CRC, or the register, of the data with the new bytes
+         */
+        P replace(P crc, uint8_t const* oldData, uint8_t const* newData, size_t len, size_t following) const
+        {
+            P difference = 0;
+
+            for (size_t i = 0; i < len; ++i)
+            {
+                add(static_cast<uint8_t>(oldData[i] ^ newData[i]), difference);
+            }
+
+            addZeros(following, difference);
+            return crc ^ difference;
+        }
+
+        /**
+         * Overwrite bytes in data so its CRC gets a wanted value ("CRC forcing"), as many bytes as
+         * the CRC has. The new bytes are the old ones plus the difference of the CRCs, moved back over
+         * the bytes following them and the bytes themselves with removeZeros(), in O(log following).
+         * Preset and invert do not matter, as long as crc was computed with the same ones.
+         * @param data      the bytes to overwrite
+         * @param following the number of bytes in the data after them
+         * @param crc       the CRC of the data as it is, or the register after adding it
+         * @param wanted    the CRC, or the register, the data shall have
+         * @throw std::logic_error if the polynomial does not fill its data type, since the CRC
+         *                         is not made of whole bytes then
+         */
+        void force(uint8_t* data, size_t following, P const& crc, P const& wanted) const
+        {
+            if (!fullWidth)
+            {
+                throw std::logic_error("CRC forcing needs a polynomial which fills its data type");
+            }
+
+            P difference = crc ^ wanted;
+            removeZeros(following + sizeof(data_type), difference);
+
+            // The bytes of the register in the order add() takes them
+            uint64_t bytes = registerBytes(difference);
+
+            for (size_t i = 0; i < sizeof(data_type); ++i)
+            {
+                data[i] ^= static_cast<uint8_t>(bytes >> (8 * i));
+            }
+        }
+
+        /**
+         * Add a sequence of identical bytes to the calculation in O(log n).
+         * @param data the value of the bytes
+         * @param n    the number of bytes to add
+         * @param reg  the working register
+         * @see addZeros()
+         */
+        void addFill(uint8_t data, size_t n, P& reg) const
+        {
+            // Contribution of 2^k bytes of data to a zero register, starting with k = 0
+            P fill = 0;
+            add(data, fill);
+
+            for (unsigned int k = 0; n != 0; ++k, n >>= 1)
+            {
+                if (n & 1)
+                {
+                    reg = multiply(reg, _zeros[k]) ^ fill;
+                }
+
+                if (n > 1)
+                {
+                    fill = multiply(fill, _zeros[k]) ^ fill;
+                }
+            }
+        }
+
+        /**
+         * Multiply two polynomials modulo the generator polynomial.
+         * @param a the first factor
+         * @param b the second factor
+         * @return a * b mod G
+         */
+        P multiply(P a, P const& b) const
+        {
+            P product = 0;
+
+            for (unsigned int i = 0; i < P::numbits; ++i)
+            {
+                product = product.hibit() ? (product.shift(1) ^ _generator) : product.shift(1);
+
+                if (a.hibit())
+                {
+                    product = product ^ b;
+                }
+
+                a = a.shift(1);
+            }
+
+            return product;
+        }
+
+        /**
+         * Multiply a register with X^-1 modulo G, undoing addbit(0, reg)
+         * @param reg the register
+         * @return reg * X^-1 mod G
+         */
+        P unshift(P const& reg) const
+        {
+            // After a shift, X^0 is only set by the feedback
+            uint64_t const mask = ~0ULL >> (64 - P::numbits);
+            uint64_t feedback = reg.lobit();
+            uint64_t value = static_cast<data_type>(reg) ^ (feedback ? static_cast<data_type>(_generator) : 0);
+
+            if (P::reflected)
+            {
+                value = ((value << 1) | feedback) & mask;
+            }
+            else
+            {
+                value = (value >> 1) | (feedback << (P::numbits - 1));
+            }
+
+            return static_cast<data_type>(value);
+        }
+
+        void addbit(uint8_t bit, P& reg) const
+        {
+            if (bit ^ reg.hibit())
+            {
+                reg = reg.shift(1) ^ _generator;
+            }
+            else
+            {
+                reg = reg.shift(1);
+            }
+        }
+
+        P generator() const
+        {
+            return _generator;
+        }
+
+        /// @return the table for one byte, or 0 if the tables are smaller
+        P const* table() const
         {
             return _table;
         }
-    protected:
+    protected:
+        typedef typename P::data_type data_type;
+        typedef void (*kernel_type)(CRC const& crc, uint8_t const* data, size_t len, P& reg);
+        typedef void (*byte_type)(CRC const& crc, uint8_t data, P& reg);
+
+        /// The size of the blocks which copyAndAdd() copies and adds in one go
+        static size_t const copyBlockSize = 4096;
+
+        /// Buffers of a scatter/gather list shorter than this are gathered before they are added
+        static size_t const gatherSize = 256;
+
+        /// Number of zero byte multipliers: one for each bit of a size_t
+        static unsigned int const numZeros = sizeof(size_t) * 8;
+
+        /// Minimum size for copyAndAdd() to bypass the cache for the destination
+        static size_t const streamingThreshold = 256 * 1024;
+
+        /// Number of folding distances: 128, 256, 512 and 1024 bits
+        static unsigned int const numFolds = 4;
+
+        /// Number of buffers the folding kernels add in parallel
+        static unsigned int const numLanes = 4;
+
+        /// Maximum length for the unrolled fixed length add()
+        static size_t const maxFixed = 64;
+
+        /// Buffers from this length on are not interleaved with the crc32 instruction
+        static size_t const maxCRC32CLanes = 512;
+
+        /// All kernels except the byte wise one need the register to fill its data type
+        static bool const fullWidth = P::numbits == sizeof(data_type) * 8;
+
+        /**
+         * X^n mod G as operand for carry-less multiplication: the coefficient of X^63 is in bit 0
+         * for reflected polynomials, and the coefficient of X^0 is in bit 0 otherwise.
+         */
+        uint64_t foldConstant(unsigned int n) const
+        {
+            P k = P::one();
+            addZeros(n / 8, k);
+
+            for (unsigned int i = 0; i < n % 8; ++i)
+            {
+                addbit(0, k);
+            }
+
+            return P::reflected ? static_cast<uint64_t>(k) << (64 - P::numbits) : static_cast<uint64_t>(k);
+        }
+
+        /**
+         * floor(X^(64+n) / G) without its X^64 coefficient, for Barrett reduction, with n = P::numbits.
+         * The quotient bits are the bits shifted out of a register which starts with G - X^n.
+         * The coefficient of X^63 is in bit 0 for reflected polynomials, and the coefficient of X^0 otherwise.
+         */
+        uint64_t barrettConstant() const
+        {
+            P reg = _generator;
+            uint64_t quotient = 0;
+
+            for (unsigned int i = 64; i > 0; --i)
+            {
+                uint64_t bit = reg.hibit() ? 1 : 0;
+                quotient |= bit << (P::reflected ? 64 - i : i - 1);
+                reg = shiftBits(reg, _generator, 1);
+            }
+
+            return quotient;
+        }
+
+        static uint64_t byteSwap(uint64_t value)
+        {
+            value = ((value & 0x00FF00FF00FF00FFULL) << 8) | ((value >> 8) & 0x00FF00FF00FF00FFULL);
+            value = ((value & 0x0000FFFF0000FFFFULL) << 16) | ((value >> 16) & 0x0000FFFF0000FFFFULL);
+            return (value << 32) | (value >> 32);
+        }
+
+        /// Resolve KernelAuto, and check that the kernel is supported
+        Kernel select(Kernel kernel) const
+        {
+            if (kernel == KernelAuto)
+            {
+                kernel = forcedKernel();
+            }
+
+            if (kernel == KernelAuto)
+            {
+                static Kernel const preference[] = { KernelVPCLMul, KernelCLMul, KernelCRC32C, KernelWord, KernelSlicing };
+                kernel = KernelTable;
+
+                for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]) && kernel == KernelTable; ++i)
+                {
+                    if (supports(preference[i]))
+                    {
+                        kernel = preference[i];
+                    }
+                }
+
+                // Without a byte table, the table kernel would go by nibbles or bits
+                if (kernel == KernelTable && _table == 0 && supports(KernelSparse))
+                {
+                    kernel = KernelSparse;
+                }
+            }
+
+            if (!supports(kernel))
+            {
+                throw std::runtime_error(std::string("CRC kernel not supported: ") + kernelName(kernel));
+            }
+
+            return kernel;
+        }
+
+        /// @return the kernel named by the environment variable CRCPP_KERNEL if it is supported, KernelAuto otherwise
+        Kernel forcedKernel() const
+        {
+            Kernel kernel = kernelFromName(std::getenv("CRCPP_KERNEL"));
+            return supports(kernel) ? kernel : KernelAuto;
+        }
+
+        /**
+         * Select the kernels for short data, which the folding kernels use for their head and tail,
+         * and for fixed length data, to go with the kernel for bulk data
+         * @param crc32c whether to use the crc32 instruction
+         */
+        void setSmallKernels(bool crc32c)
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            if (crc32c)
+            {
+                _short = &addCRC32C;
+            }
+            else if (_words != 0)
+            {
+                _short = &addWord;
+            }
+            else if (_slices != 0)
+            {
+                _short = _tables == TablesSlicing4 ? &addSlicing4 : (_tables == TablesSlicing8 ? &addSlicing8 : &addSlicing16);
+            }
+            else
+            {
+                _short = &addTable;
+            }
+
+            if (crc32c)
+            {
+                _small = KernelCRC32C;
+                return;
+            }
+
+            if (_kernel == KernelCLMul || _kernel == KernelVPCLMul)
+            {
+                _small = KernelCLMul;
+                return;
+            }
+#else
+            (void) crc32c;
+#endif
+
+            _small = _slices != 0 && _tables != TablesSlicing4 && _kernel != KernelTable ? KernelSlicing : KernelTable;
+        }
+
+        /// @return the implementation of a supported kernel
+        kernel_type bulkKernel(Kernel kernel) const
+        {
+            switch (kernel)
+            {
+            case KernelSlicing:
+                return _tables == TablesSlicing4 ? &addSlicing4 : (_tables == TablesSlicing8 ? &addSlicing8 : &addSlicing16);
+
+            case KernelWord:
+                return &addWord;
+
+            case KernelSparse:
+                return &addSparse;
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            case KernelCLMul:
+                return &addCLMul;
+
+            case KernelVPCLMul:
+                return &addVPCLMul;
+
+            case KernelCRC32C:
+                return &addCRC32C;
+#endif
+
+            default:
+                return &addTable;
+            }
+        }
+
+        /// The kernel for different kernels by size class, see setKernels()
+        static void addBySize(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            crc._bySize[sizeClass(len)](crc, data, len, reg);
+        }
+
+        static void addTable(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            P const* table = crc._table;
+
+            if (table == 0)
+            {
+                for (; len > 0; --len)
+                {
+                    crc.addSmall(*data++, reg);
+                }
+
+                return;
+            }
+
+            for (; len > 0; --len)
+            {
+                reg = reg.shift(8) ^ table[reg.hibyte() ^ *data++];
+            }
+        }
+
+        /*
+         * The sparse kernel reduces the data modulo G(X^64) = G^64, a multiple of G with as many coefficients
+         * as G, all of them at multiples of 64 bits. Each 64 bit word of the data which is followed by at least
+         * 64n more bits is replaced by adding it to the words 64(n - i) bits further on, for each coefficient X^i
+         * of G - X^n, so the CRC only depends on the last 8n bytes. This is the idea of Chorba (Kadatch and Jenkins),
+         * with the multiple of G chosen so that no shifts are needed. Rather than adding each word to the words
+         * after it, each word gets the sum of the reduced words before it, from a ring of the last 2n words:
+         * one store and at most n loads and XORs per 8 bytes, without any lookups. The table kernel adds
+         * the last 8n bytes, plus what the reduced words add to them.
+         */
+        static void addSparse(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            size_t const n = P::numbits;
+
+            if (len < 16 * n)
+            {
+                addTable(crc, data, len, reg);
+                return;
+            }
+
+            size_t const mask = 2 * n - 1;
+            uint64_t ring[2 * n];
+            std::memset(ring, 0, sizeof(ring));
+
+            // Distances as offsets into the ring, which is indexed by the word number plus 2n
+            size_t offsets[P::numbits];
+            size_t const count = crc._numSparse;
+
+            for (size_t k = 0; k < count; ++k)
+            {
+                offsets[k] = 2 * n - crc._sparse[k];
+            }
+
+            // The register is added to the first bytes, which leaves a zero register
+            uint64_t first = registerBytes(reg);
+            reg = 0;
+
+            size_t const words = len / 8 - n;
+
+            for (size_t i = 0; i < words; ++i)
+            {
+                uint64_t word = loadBytes(data + 8 * i, 8) ^ first;
+                first = 0;
+
+                for (size_t k = 0; k < count; ++k)
+                {
+                    word ^= ring[(i + offsets[k]) & mask];
+                }
+
+                ring[i & mask] = word;
+            }
+
+            // The last bytes, with the sums of the reduced words before them
+            uint8_t tail[8 * n + 8];
+            size_t rest = len - 8 * words;
+            std::memcpy(tail, data + 8 * words, rest);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint64_t word = 0;
+
+                for (size_t k = 0; k < count; ++k)
+                {
+                    // Only words which have been reduced
+                    if (crc._sparse[k] > i)
+                    {
+                        word ^= ring[(words + i + offsets[k]) & mask];
+                    }
+                }
+
+                for (size_t b = 0; b < 8; ++b)
+                {
+                    tail[8 * i + b] ^= static_cast<uint8_t>(word >> (8 * b));
+                }
+            }
+
+            addTable(crc, tail, rest, reg);
+        }
+
+        /// Shift a register by n bits, with the generator polynomial as feedback
+        static P shiftBits(P reg, P const& generator, int n)
+        {
+            for (int bit = 0; bit < n; ++bit)
+            {
+                reg = reg.hibit() ? (reg.shift(1) ^ generator) : reg.shift(1);
+            }
+
+            return reg;
+        }
+
+        void buildTables()
+        {
+            size_t const sizes[] = { 0, 16, 256, 4 * 256, 8 * 256, 16 * 256, 256 + 65536 };
+            std::shared_ptr<std::vector<P> > storage(new std::vector<P>(sizes[_tables]));
+            P* table = storage->empty() ? 0 : &(*storage)[0];
+
+            if (_tables == TablesNibble)
+            {
+                // The nibble is in the bits of the register which are shifted out first
+                for (unsigned int index = 0; index < 16; ++index)
+                {
+                    P crc;
+                    crc.sethibyte(static_cast<uint8_t>(P::reflected ? index : index << 4));
+                    table[index] = shiftBits(crc, _generator, 4);
+                }
+
+                _nibbles = table;
+            }
+            else if (_tables != TablesNone)
+            {
+                for (unsigned int index = 0; index < 256; index++)
+                {
+                    P crc;
+                    crc.sethibyte(static_cast<uint8_t>(index));
+                    table[index] = shiftBits(crc, _generator, 8);
+                }
+
+                _table = table;
+                _byte = &addByteTable;
+
+                if (_tables == TablesWord)
+                {
+                    // Entry a + 256 b: the bytes a, b
+                    for (unsigned int index = 0; index < 65536; ++index)
+                    {
+                        P crc = 0;
+                        add(static_cast<uint8_t>(index), crc);
+                        add(static_cast<uint8_t>(index >> 8), crc);
+                        table[256 + index] = crc;
+                    }
+
+                    _words = table + 256;
+                }
+                else if (_tables != TablesByte)
+                {
+                    // Slice k: a byte followed by k zero bytes
+                    for (size_t index = 256; index < storage->size(); ++index)
+                    {
+                        table[index] = table[index - 256];
+                        add(0, table[index]);
+                    }
+
+                    _slices = table;
+                }
+            }
+
+            _storage = storage;
+        }
+
+        /// Add a byte with the byte table
+        static void addByteTable(CRC const& crc, uint8_t data, P& reg)
+        {
+            reg = reg.shift(8) ^ crc._table[reg.hibyte() ^ data];
+        }
+
+        /// Add a byte without a byte table
+        static void addByteSmall(CRC const& crc, uint8_t data, P& reg)
+        {
+            crc.addSmall(data, reg);
+        }
+
+        /// Add a byte without a byte table
+        void addSmall(uint8_t data, P& reg) const
+        {
+            if (_nibbles != 0)
+            {
+                uint8_t index = reg.hibyte() ^ data;
+                reg = reg.shift(4) ^ _nibbles[P::reflected ? (index & 0x0F) : (index >> 4)];
+                index = reg.hibyte() ^ static_cast<uint8_t>(P::reflected ? (data >> 4) : (data << 4));
+                reg = reg.shift(4) ^ _nibbles[P::reflected ? (index & 0x0F) : (index >> 4)];
+            }
+            else
+            {
+                P work;
+                work.sethibyte(data);
+                reg = shiftBits(reg ^ work, _generator, 8);
+            }
+        }
+
+        /// Load up to 8 bytes: byte i is in bits 8i ... 8i+7
+        static uint64_t loadBytes(uint8_t const* data, size_t n)
+        {
+            uint64_t block = 0;
+            std::memcpy(&block, data, n);
+#if defined (__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            block = byteSwap(block);
+#endif
+            return block;
+        }
+
+        /// The register as bytes to be added to the next data, in the order of loadBytes()
+        static uint64_t registerBytes(P const& reg)
+        {
+            uint64_t work = static_cast<data_type>(reg);
+            return P::reflected ? work : byteSwap(work << (64 - P::numbits));
+        }
+
+        /// Sum of the slices for a block of 4 bytes, slices[0] being the table for the last byte
+        static P lookup4(P const* slices, uint64_t block)
+        {
+            return slices[3 * 256 + (block & 0xFF)]         ^ slices[2 * 256 + ((block >> 8) & 0xFF)] ^
+                   slices[1 * 256 + ((block >> 16) & 0xFF)] ^ slices[0 * 256 + ((block >> 24) & 0xFF)];
+        }
+
+        /// Sum of the slices for a block of 8 bytes
+        static P lookup8(P const* slices, uint64_t block)
+        {
+            return slices[7 * 256 + (block & 0xFF)]         ^ slices[6 * 256 + ((block >> 8) & 0xFF)] ^
+                   slices[5 * 256 + ((block >> 16) & 0xFF)] ^ slices[4 * 256 + ((block >> 24) & 0xFF)] ^
+                   slices[3 * 256 + ((block >> 32) & 0xFF)] ^ slices[2 * 256 + ((block >> 40) & 0xFF)] ^
+                   slices[1 * 256 + ((block >> 48) & 0xFF)] ^ slices[0 * 256 + (block >> 56)];
+        }
+
+        static void addSlicing4(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            for (; len >= 4; len -= 4, data += 4)
+            {
+                reg = lookup4(crc._slices, loadBytes(data, 4) ^ registerBytes(reg));
+            }
+
+            addTable(crc, data, len, reg);
+        }
+
+        static void addSlicing8(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            for (; len >= 8; len -= 8, data += 8)
+            {
+                reg = lookup8(crc._slices, loadBytes(data, 8) ^ registerBytes(reg));
+            }
+
+            addTable(crc, data, len, reg);
+        }
+
+        static void addSlicing16(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            for (; len >= 16; len -= 16, data += 16)
+            {
+                reg = lookup8(crc._slices + 8 * 256, loadBytes(data, 8) ^ registerBytes(reg)) ^
+                      lookup8(crc._slices, loadBytes(data + 8, 8));
+            }
+
+            addTable(crc, data, len, reg);
+        }
+
+        /// Copy and add, see copyAndAdd()
+        void copyBlocks(uint8_t* dst, uint8_t const* src, size_t len, P& reg) const
+        {
+#if defined (CRCPP_HAVE_SSE2)
+
+            if (len >= streamingThreshold)
+            {
+                // Align the destination for the streaming stores
+                size_t head = (16 - (reinterpret_cast<size_t>(dst) & 15)) & 15;
+                std::memcpy(dst, src, head);
+                _bulk(*this, src, head, reg);
+                dst += head;
+                src += head;
+                len -= head;
+
+                for (; len >= copyBlockSize; len -= copyBlockSize)
+                {
+                    for (size_t i = 0; i < copyBlockSize; i += 16)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+                        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), v);
+                    }
+
+                    _bulk(*this, src, copyBlockSize, reg);
+                    dst += copyBlockSize;
+                    src += copyBlockSize;
+                }
+
+                _mm_sfence();
+            }
+
+#endif
+
+            while (len > 0)
+            {
+                size_t chunk = len < copyBlockSize ? len : copyBlockSize;
+                std::memcpy(dst, src, chunk);
+                _bulk(*this, src, chunk, reg);
+                dst += chunk;
+                src += chunk;
+                len -= chunk;
+            }
+        }
+
+        /// Add several buffers, see add()
+        void addBuffers(uint8_t const* const* data, size_t const* len, P* reg, size_t count) const
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+            if (_small == KernelCRC32C)
+            {
+                addCRC32CLanes(*this, data, len, reg, count);
+                return;
+            }
+
+            if (_kernel == KernelCLMul || _kernel == KernelVPCLMul)
+            {
+                for (; count >= numLanes; count -= numLanes, data += numLanes, len += numLanes, reg += numLanes)
+                {
+                    addCLMulLanes(*this, data, len, reg);
+                }
+            }
+
+#endif
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                _bulk(*this, data[i], len[i], reg[i]);
+            }
+        }
+
+        /// @return the kernel which add() of several buffers uses for buffer i of count
+        Kernel bufferKernel(size_t i, size_t count, size_t len) const
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+            if (_small == KernelCRC32C)
+            {
+                return KernelCRC32C;
+            }
+
+            if ((_kernel == KernelCLMul || _kernel == KernelVPCLMul) && i < count - count % numLanes)
+            {
+                return KernelCLMul;
+            }
+
+#endif
+
+            (void) i;
+            (void) count;
+            return kernel(len);
+        }
+
+        /// Add a block of N bytes, see add()
+        template <size_t N> void addBlock(uint8_t const (&data)[N], P& reg) const
+        {
+            if (N > maxFixed)
+            {
+                _bulk(*this, data, N, reg);
+                return;
+            }
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+            if (_small == KernelCRC32C)
+            {
+                addCRC32CFixed<(N <= maxFixed ? N : 0)>(*this, data, reg);
+                return;
+            }
+
+            if (_small == KernelCLMul && (N <= 16 || N >= 64))
+            {
+                if (N <= 16)
+                {
+                    addBarrett<(N <= 16 ? N : 0)>(data, reg);
+                }
+                else
+                {
+                    _bulk(*this, data, N, reg);
+                }
+
+                return;
+            }
+
+#endif
+
+            if (_small == KernelSlicing)
+            {
+                addFixed<(N <= maxFixed ? N : 0)>(data, reg, std::integral_constant<bool, (N >= 8 && N <= maxFixed)>());
+            }
+            else
+            {
+                addFixed<(N <= maxFixed ? N : 0)>(data, reg, std::false_type());
+            }
+        }
+
+        /// @return the kernel which add() of a fixed size block of N bytes uses
+        Kernel blockKernel(size_t N) const
+        {
+            if (N > maxFixed)
+            {
+                return kernel(N);
+            }
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+            if (_small == KernelCRC32C)
+            {
+                return KernelCRC32C;
+            }
+
+            if (_small == KernelCLMul && (N <= 16 || N >= 64))
+            {
+                return N <= 16 ? KernelCLMul : kernel(N);
+            }
+
+#endif
+
+            return _small == KernelSlicing && N >= 8 ? KernelSlicing : KernelTable;
+        }
+
+        /// Record a call in the metrics
+        void record(MetricsHook& metrics, Kernel kernel, size_t len, uint64_t nanoseconds) const
+        {
+            metrics.record(static_cast<uint64_t>(static_cast<data_type>(_generator)), P::numbits, P::reflected, kernel, len, nanoseconds);
+        }
+
+        /// Add N bytes, 8 at a time with the slicing tables
+        template <size_t N> void addFixed(uint8_t const* data, P& reg, std::true_type /* N >= 8 */) const
+        {
+            reg = lookup8(_slices, loadBytes(data, 8) ^ registerBytes(reg));
+            addFixed<N - 8>(data + 8, reg, std::integral_constant<bool, (N >= 16)>());
+        }
+
+        /// Add N bytes, one at a time
+        template <size_t N> void addFixed(uint8_t const* data, P& reg, std::false_type) const
+        {
+            for (size_t i = 0; i < N; ++i)
+            {
+                add(data[i], reg);
+            }
+        }
+
+        static void addWord(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            for (; len >= 2; len -= 2, data += 2)
+            {
+                P rest = reg.shift(8);
+                unsigned int index = (reg.hibyte() ^ data[0]) | ((rest.hibyte() ^ data[1]) << 8);
+                reg = P(rest.shift(8)) ^ crc._words[index];
+            }
+
+            addTable(crc, data, len, reg);
+        }
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+
+        /*
+         * The folding kernels keep 128 bit blocks of pending data. A block is moved forward
+         * by d bits by multiplying its two halves with X^(d+64) mod G and X^d mod G, which yields
+         * a 128 bit block with the same remainder. Reflected polynomials are loaded as they are,
+         * which puts X^0 on the left, so their constants are divided by X. Others are byte swapped.
+         * The register is added to the first block. The final block and short data are added with
+         * slicing, or with the crc32 instruction for CRC-32C.
+         */
+
+        CRCPP_TARGET("ssse3")
+        static __m128i load(uint8_t const* data)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data));
+            return P::reflected ? block : _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        }
+
+        CRCPP_TARGET("pclmul")
+        static __m128i fold(__m128i block, __m128i constant)
+        {
+            return _mm_xor_si128(_mm_clmulepi64_si128(block, constant, 0x00), _mm_clmulepi64_si128(block, constant, 0x11));
+        }
+
+        CRCPP_TARGET("ssse3")
+        static __m128i registerBlock(P const& reg)
+        {
+            uint64_t value = static_cast<uint64_t>(static_cast<data_type>(reg));
+            return P::reflected ? _mm_set_epi64x(0, static_cast<int64_t>(value))
+                                : _mm_set_epi64x(static_cast<int64_t>(value << (64 - P::numbits)), 0);
+        }
+
+        CRCPP_TARGET("pclmul,ssse3")
+        static void finish(CRC const& crc, __m128i block, uint8_t const* data, size_t len, P& reg)
+        {
+            __m128i const fold128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[0]));
+
+            for (; len >= 16; len -= 16, data += 16)
+            {
+                block = _mm_xor_si128(fold(block, fold128), load(data));
+            }
+
+            if (!P::reflected)
+            {
+                block = _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+            }
+
+            uint8_t pending[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pending), block);
+            reg = 0;
+            crc._short(crc, pending, sizeof(pending), reg);
+            crc._short(crc, data, len, reg);
+        }
+
+        CRCPP_TARGET("pclmul,ssse3")
+        static void addCLMul(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            if (len < 64)
+            {
+                crc._short(crc, data, len, reg);
+                return;
+            }
+
+            __m128i const fold128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[0]));
+            __m128i const fold512 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[2]));
+            __m128i x0 = _mm_xor_si128(load(data), registerBlock(reg));
+            __m128i x1 = load(data + 16);
+            __m128i x2 = load(data + 32);
+            __m128i x3 = load(data + 48);
+
+            for (data += 64, len -= 64; len >= 64; data += 64, len -= 64)
+            {
+                x0 = _mm_xor_si128(fold(x0, fold512), load(data));
+                x1 = _mm_xor_si128(fold(x1, fold512), load(data + 16));
+                x2 = _mm_xor_si128(fold(x2, fold512), load(data + 32));
+                x3 = _mm_xor_si128(fold(x3, fold512), load(data + 48));
+            }
+
+            x1 = _mm_xor_si128(fold(x0, fold128), x1);
+            x2 = _mm_xor_si128(fold(x1, fold128), x2);
+            x3 = _mm_xor_si128(fold(x2, fold128), x3);
+            finish(crc, x3, data, len, reg);
+        }
+
+        CRCPP_TARGET("pclmul,ssse3")
+        static void addCLMulLanes(CRC const& crc, uint8_t const* const* data, size_t const* len, P* reg)
+        {
+            // The blocks all buffers have are folded in parallel, the rest of each buffer on its own
+            size_t common = std::min(std::min(len[0], len[1]), std::min(len[2], len[3])) & ~static_cast<size_t>(15);
+
+            if (common < 32)
+            {
+                for (unsigned int i = 0; i < numLanes; ++i)
+                {
+                    crc._bulk(crc, data[i], len[i], reg[i]);
+                }
+
+                return;
+            }
+
+            __m128i const fold128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[0]));
+            __m128i x0 = _mm_xor_si128(load(data[0]), registerBlock(reg[0]));
+            __m128i x1 = _mm_xor_si128(load(data[1]), registerBlock(reg[1]));
+            __m128i x2 = _mm_xor_si128(load(data[2]), registerBlock(reg[2]));
+            __m128i x3 = _mm_xor_si128(load(data[3]), registerBlock(reg[3]));
+
+            for (size_t pos = 16; pos < common; pos += 16)
+            {
+                x0 = _mm_xor_si128(fold(x0, fold128), load(data[0] + pos));
+                x1 = _mm_xor_si128(fold(x1, fold128), load(data[1] + pos));
+                x2 = _mm_xor_si128(fold(x2, fold128), load(data[2] + pos));
+                x3 = _mm_xor_si128(fold(x3, fold128), load(data[3] + pos));
+            }
+
+            finish(crc, x0, data[0] + common, len[0] - common, reg[0]);
+            finish(crc, x1, data[1] + common, len[1] - common, reg[1]);
+            finish(crc, x2, data[2] + common, len[2] - common, reg[2]);
+            finish(crc, x3, data[3] + common, len[3] - common, reg[3]);
+        }
+
+        CRCPP_TARGET("avx2")
+        static __m256i load256(uint8_t const* data)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data));
+            return P::reflected ? block : _mm256_shuffle_epi8(block, _mm256_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                                                                     0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        }
+
+        CRCPP_TARGET("avx2,vpclmulqdq")
+        static __m256i fold256(__m256i block, __m256i constant)
+        {
+            return _mm256_xor_si256(_mm256_clmulepi64_epi128(block, constant, 0x00), _mm256_clmulepi64_epi128(block, constant, 0x11));
+        }
+
+        CRCPP_TARGET("avx2,vpclmulqdq,pclmul,ssse3")
+        static void addVPCLMul(CRC const& crc, uint8_t const* data, size_t len, P& reg)
+        {
+            if (len < 256)
+            {
+                addCLMul(crc, data, len, reg);
+                return;
+            }
+
+            __m256i const fold256bits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[1])));
+            __m256i const fold1024 = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[3])));
+            __m256i y0 = _mm256_xor_si256(load256(data), _mm256_inserti128_si256(_mm256_setzero_si256(), registerBlock(reg), 0));
+            __m256i y1 = load256(data + 32);
+            __m256i y2 = load256(data + 64);
+            __m256i y3 = load256(data + 96);
+
+            for (data += 128, len -= 128; len >= 128; data += 128, len -= 128)
+            {
+                y0 = _mm256_xor_si256(fold256(y0, fold1024), load256(data));
+                y1 = _mm256_xor_si256(fold256(y1, fold1024), load256(data + 32));
+                y2 = _mm256_xor_si256(fold256(y2, fold1024), load256(data + 64));
+                y3 = _mm256_xor_si256(fold256(y3, fold1024), load256(data + 96));
+            }
+
+            y1 = _mm256_xor_si256(fold256(y0, fold256bits), y1);
+            y2 = _mm256_xor_si256(fold256(y1, fold256bits), y2);
+            y3 = _mm256_xor_si256(fold256(y2, fold256bits), y3);
+
+            __m128i const fold128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(crc._fold[0]));
+            __m128i block = _mm_xor_si128(fold(_mm256_castsi256_si128(y3), fold128), _mm256_extracti128_si256(y3, 1));
+            finish(crc, block, data, len, reg);
+        }
+
+        /*
+         * Barrett reduction adds M <= 8 bytes D to the register R in two carry-less multiplications.
+         * With n = P::numbits, the new register is (R X^8M + D X^n) mod G = A mod G. A = Q G + (A mod G),
+         * and the quotient Q of A with degree < 64 + n is floor(floor(A / X^n) * floor(X^(64+n) / G) / X^64).
+         * The remainder are the n low coefficients of A - Q G.
+         * Reflected operands put X^63 in bit 0, so their products are one bit short of 128 bits.
+         */
+
+        CRCPP_TARGET("pclmul")
+        static __m128i clmul(uint64_t a, uint64_t b)
+        {
+            return _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(a)), _mm_cvtsi64_si128(static_cast<int64_t>(b)), 0x00);
+        }
+
+        /// Load M <= 8 bytes like loadBytes(), in loads of 8, 4, 2 and 1 bytes which do not stall on recent stores
+        template <size_t M> static uint64_t loadFixed(uint8_t const* data)
+        {
+            if (M == 8)
+            {
+                return loadBytes(data, 8);
+            }
+
+            uint64_t block = 0;
+            size_t i = 0;
+
+            if (M & 4)
+            {
+                uint32_t word;
+                std::memcpy(&word, data, sizeof(word));
+                block = word;
+                i = 4;
+            }
+
+            if (M & 2)
+            {
+                uint16_t half;
+                std::memcpy(&half, data + i, sizeof(half));
+                block |= static_cast<uint64_t>(half) << (8 * i);
+                i += 2;
+            }
+
+            if (M & 1)
+            {
+                block |= static_cast<uint64_t>(data[i]) << (8 * i);
+            }
+
+            return block;
+        }
+
+        template <size_t M> CRCPP_TARGET("pclmul")
+        void addBarrettStep(uint8_t const* data, P& reg) const
+        {
+            unsigned int const m = 8 * M;
+            unsigned int const n = P::numbits;
+            uint64_t const r = static_cast<data_type>(reg);
+            uint64_t const g = static_cast<data_type>(_generator);
+            uint64_t const d = loadFixed<M>(data);
+
+            if (P::reflected)
+            {
+                // floor(A / X^n) and the part of R X^8M below X^n
+                uint64_t a = (d ^ r) << (64 - m);
+                uint64_t low = m < n ? r >> (m % 64) : 0;
+
+                __m128i product = clmul(a, _barrett);
+                uint64_t q = (static_cast<uint64_t>(_mm_cvtsi128_si64(product)) << 1) ^ a;
+
+                product = clmul(q, g);
+                uint64_t qg = (static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product))) << 1) |
+                              (static_cast<uint64_t>(_mm_cvtsi128_si64(product)) >> 63);
+                reg = static_cast<data_type>(low ^ qg);
+            }
+            else
+            {
+                uint64_t const mask = ~0ULL >> (64 - n);
+                uint64_t a = (byteSwap(d) >> (64 - m)) ^ (m >= n ? r << ((m - n) % 64) : r >> ((n - m) % 64));
+                uint64_t low = m < n ? (r << (m % 64)) & mask : 0;
+
+                __m128i product = clmul(a, _barrett);
+                uint64_t q = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product))) ^ a;
+
+                product = clmul(q, g);
+                reg = static_cast<data_type>(low ^ (static_cast<uint64_t>(_mm_cvtsi128_si64(product)) & mask));
+            }
+        }
+
+        /// Add N <= 16 bytes: the bytes which do not make up a block of 8 first
+        template <size_t N> CRCPP_TARGET("pclmul")
+        void addBarrett(uint8_t const* data, P& reg) const
+        {
+            if (N % 8 != 0)
+            {
+                addBarrettStep<(N % 8 != 0 ? N % 8 : 8)>(data, reg);
+            }
+
+            for (size_t i = N % 8; i < N; i += 8)
+            {
+                addBarrettStep<8>(data + i, reg);
+            }
+        }
+
+        template <size_t N> CRCPP_TARGET("sse4.2")
+        static void addCRC32CFixed(CRC const& crc, uint8_t const* data, P& reg)
+        {
+            addCRC32C(crc, data, N, reg);
+        }
+
+        /// A buffer being added by addCRC32CLanes()
+        struct CRC32CLane
+        {
+            uint8_t const* pos;
+            size_t left;
+            size_t buffer;
+            uint64_t work;
+            bool busy;
+        };
+
+        CRCPP_TARGET("sse4.2")
+        static void stepCRC32C(CRC32CLane& lane)
+        {
+            uint64_t block;
+            std::memcpy(&block, lane.pos, sizeof(block));
+            lane.work = _mm_crc32_u64(lane.work, block);
+            lane.pos += 8;
+        }
+
+        CRCPP_TARGET("sse4.2")
+        static void finishCRC32C(CRC const& crc, CRC32CLane& lane, P* reg)
+        {
+            if (lane.busy)
+            {
+                reg[lane.buffer] = static_cast<data_type>(lane.work);
+                addCRC32C(crc, lane.pos, lane.left, reg[lane.buffer]);
+                lane.busy = false;
+            }
+        }
+
+        /// Finish the buffer of a lane if less than 8 bytes are left, and take the next short buffer
+        CRCPP_TARGET("sse4.2")
+        static void refillCRC32C(CRC const& crc, CRC32CLane& lane, uint8_t const* const* data, size_t const* len, P* reg,
+                                 size_t count, size_t& next)
+        {
+            if (lane.left < 8)
+            {
+                finishCRC32C(crc, lane, reg);
+            }
+
+            for (; !lane.busy && next < count; ++next)
+            {
+                if (len[next] >= maxCRC32CLanes)
+                {
+                    crc._bulk(crc, data[next], len[next], reg[next]);
+                }
+                else
+                {
+                    lane.pos = data[next];
+                    lane.left = len[next];
+                    lane.buffer = next;
+                    lane.work = static_cast<data_type>(reg[next]);
+                    lane.busy = true;
+                }
+            }
+        }
+
+        CRCPP_TARGET("sse4.2")
+        static void addCRC32CLanes(CRC const& crc, uint8_t const* const* data, size_t const* len, P* reg, size_t count)
+        {
+            // The crc32 instruction takes three cycles, but starts one every cycle: each lane adds one buffer,
+            // and a lane whose buffer is done takes the next one. Long buffers go to the bulk kernel,
+            // which folds with carry-less multiplication if it can.
+            CRC32CLane lane0 = CRC32CLane();
+            CRC32CLane lane1 = CRC32CLane();
+            CRC32CLane lane2 = CRC32CLane();
+            CRC32CLane lane3 = CRC32CLane();
+            size_t next = 0;
+
+            for (;;)
+            {
+                refillCRC32C(crc, lane0, data, len, reg, count, next);
+                refillCRC32C(crc, lane1, data, len, reg, count, next);
+                refillCRC32C(crc, lane2, data, len, reg, count, next);
+                refillCRC32C(crc, lane3, data, len, reg, count, next);
+
+                if (!lane0.busy || !lane1.busy || !lane2.busy || !lane3.busy)
+                {
+                    break;
+                }
+
+                size_t steps = std::min(std::min(lane0.left, lane1.left), std::min(lane2.left, lane3.left)) / 8;
+
+                for (size_t step = 0; step < steps; ++step)
+                {
+                    stepCRC32C(lane0);
+                    stepCRC32C(lane1);
+                    stepCRC32C(lane2);
+                    stepCRC32C(lane3);
+                }
+
+                lane0.left -= 8 * steps;
+                lane1.left -= 8 * steps;
+                lane2.left -= 8 * steps;
+                lane3.left -= 8 * steps;
+            }
+
+            // Less than four buffers are left
+            finishCRC32C(crc, lane0, reg);
+            finishCRC32C(crc, lane1, reg);
+            finishCRC32C(crc, lane2, reg);
+            finishCRC32C(crc, lane3, reg);
+        }
+
+        CRCPP_TARGET("sse4.2")
+        static void addCRC32C(CRC const& /* crc */, uint8_t const* data, size_t len, P& reg)
+        {
+            uint64_t work = static_cast<data_type>(reg);
+
+            for (; len >= 8; len -= 8, data += 8)
+            {
+                uint64_t block;
+                std::memcpy(&block, data, sizeof(block));
+                work = _mm_crc32_u64(work, block);
+            }
+
+            uint32_t rest = static_cast<uint32_t>(work);
+
+            if (len & 4)
+            {
+                uint32_t block;
+                std::memcpy(&block, data, sizeof(block));
+                rest = _mm_crc32_u32(rest, block);
+                data += 4;
+            }
+
+            if (len & 2)
+            {
+                uint16_t block;
+                std::memcpy(&block, data, sizeof(block));
+                rest = _mm_crc32_u16(rest, block);
+                data += 2;
+            }
+
+            if (len & 1)
+            {
+                rest = _mm_crc32_u8(rest, *data);
+            }
+
+            reg = static_cast<data_type>(rest);
+        }
+
+#endif
+
         P _generator;
-        P _table[256];
+        P _zeros[numZeros];
+        uint64_t _fold[numFolds][2];
+        Tables _tables;
+        std::shared_ptr<std::vector<P> const> _storage;    ///< the tables, shared by copies
+        P const* _table;
+        byte_type _byte;        ///< adds a single byte, with the byte table if there is one
+        P const* _nibbles;
+        P const* _slices;
+        P const* _words;
+        Kernel _kernel;
+        kernel_type _bulk;
+        Kernel _kernels[numSizeClasses];        ///< the kernel for each size class, see setKernels()
+        kernel_type _bySize[numSizeClasses];
+#if defined (CRCPP_HAVE_X86_KERNELS)
+        kernel_type _short;
+#endif
+        Kernel _small;          ///< the kernel for fixed length data
+        uint8_t _sparse[P::numbits];    ///< the distances in words of the sparse kernel
+        unsigned int _numSparse;
+        uint64_t _barrett;      ///< the constant for Barrett reduction
     };
+
+#if defined (CRCPP_EXTERN_TEMPLATES)
+    // The standard polynomials are instantiated once, in the crcpp library
+    extern template class CRC<Poly64N>;
+    extern template class CRC<Poly32N>;
+    extern template class CRC<Poly16N>;
+    extern template class CRC<Poly8N>;
+    extern template class CRC<Poly64>;
+    extern template class CRC<Poly32>;
+    extern template class CRC<Poly16>;
+    extern template class CRC<Poly8>;
+#endif
 }
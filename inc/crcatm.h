@@ -0,0 +1,342 @@
+#pragma once
+/*
+ * crcatm.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcatm.h
+ * @brief Contains the cell delineation of ATM (ITU-T I.432), which finds cell boundaries by their HEC
+ */
+
+#include "crccorrect.h"
+#include "crcroll.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace CrcPP
+{
+    /**
+     * The states of cell delineation
+     * @ingroup CRCpp
+     */
+    enum DelineationState
+    {
+        DelineationHunt,        ///< looking for a header with a correct HEC at every byte
+        DelineationPresync,     ///< checking the headers of the following cells
+        DelineationSync         ///< cell boundaries found, cells are delivered
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief Finds the boundaries of ATM cells in a byte stream, using the HEC of the cell headers
+     *
+     * Cell delineation as of ITU-T I.432.1, on octet boundaries:
+     * - HUNT: the HEC is checked at every byte, with a rolling CRC over the last 5 bytes (see CRCRolling),
+     *   so each byte costs one table lookup. A correct HEC leads to PRESYNC.
+     * - PRESYNC: the header of each following cell is checked. After @c delta correct HECs in a row, the
+     *   cells are in SYNC. A single incorrect HEC leads back to HUNT.
+     * - SYNC: cells are delivered. After @c alpha incorrect HECs in a row, the cells are lost and hunting
+     *   starts over.
+     *
+     * In SYNC, a header with a single bit error is corrected, unless the previous header had an error as well
+     * (correction and detection mode of I.432). Cells with headers which are not corrected are discarded.
+     *
+     * The defaults are those of the @c hec algorithm of the crc tool: CRC-8 with the generator
+     * X^8 + X^2 + X + 1 (Poly8N 0xE0), no preset, and the HEC xor'ed with 0x55.
+     */
+    template <class P> class CellDelineator
+    {
+    public:
+        typedef typename P::data_type data_type;
+
+        /// The size of a cell header, including the HEC
+        static size_t const headerSize = 5;
+
+        /// The size of a cell
+        static size_t const cellSize = 53;
+
+        /**
+         * Cell counts since construction
+         */
+        struct Counters
+        {
+            uint64_t cells;         ///< cells delivered
+            uint64_t corrected;     ///< cells delivered with a corrected header
+            uint64_t discarded;     ///< cells discarded in SYNC, because of an incorrect HEC
+            uint64_t syncLosses;    ///< transitions from SYNC to HUNT
+        };
+
+        /**
+         * Constructor.
+         * @param algorithm   The CRC algorithm of the HEC
+         * @param preset      The preset value of the CRC register
+         * @param invert      The value the HEC is inverted (xor'ed) with
+         * @param correct     Whether to correct single bit errors in headers
+         * @param alpha       The number of incorrect HECs in a row which lose SYNC
+         * @param delta       The number of correct HECs in a row in PRESYNC which lead to SYNC
+         */
+        CellDelineator(CRC<P> const& algorithm, data_type preset = 0, data_type invert = 0x55,
+                       bool correct = true, unsigned int alpha = 7, unsigned int delta = 6) :
+            _algorithm(algorithm),
+            _rolling(algorithm, headerSize),
+            _corrector(algorithm, headerSize),
+            _good(preset),
+            _correct(correct),
+            _alpha(alpha),
+            _delta(delta)
+        {
+            if (alpha == 0 || delta == 0)
+            {
+                throw std::logic_error("Alpha and delta of cell delineation must not be 0");
+            }
+
+            // The rolling CRC starts from a zero register: a good header gives the preset, moved over the
+            // header, plus the register after adding a good HEC
+            P residue = 0;
+            _algorithm.add(P(invert), residue);
+            _algorithm.addZeros(headerSize, _good);
+            _good = _good ^ residue;
+
+            std::memset(&_counters, 0, sizeof(_counters));
+            reset();
+        }
+
+        /**
+         * Delineate data up to the end of the next cell to deliver.
+         * @param data the data
+         * @param len  the number of bytes in data
+         * @return the number of bytes of data up to and including the last byte of a cell, or 0 if no cell
+         *         is delivered within data. In that case all of data has been consumed, and delineation continues
+         *         with the next call. Otherwise, the cell is available through cell() until the next call.
+         */
+        size_t next(uint8_t const* data, size_t len)
+        {
+            size_t i = 0;
+
+            while (i < len)
+            {
+                if (_state == DelineationHunt)
+                {
+                    while (i < len && !hunt(data[i++]))
+                    {
+                    }
+                }
+                else if (_fill < headerSize)
+                {
+                    size_t n = std::min(headerSize - _fill, len - i);
+                    std::memcpy(_cell + _fill, data + i, n);
+                    _fill += n;
+                    i += n;
+
+                    if (_fill == headerSize)
+                    {
+                        checkHeader();
+                    }
+                }
+                else
+                {
+                    // Payload of cells which are not delivered is skipped
+                    size_t n = std::min(cellSize - _fill, len - i);
+
+                    if (_deliver)
+                    {
+                        std::memcpy(_cell + _fill, data + i, n);
+                    }
+
+                    _fill += n;
+                    i += n;
+
+                    if (_fill == cellSize)
+                    {
+                        _fill = 0;
+
+                        if (_deliver)
+                        {
+                            _deliver = false;
+                            return i;
+                        }
+                    }
+                }
+            }
+
+            return 0;
+        }
+
+        /// @return the last cell delivered, with its header corrected
+        uint8_t const* cell() const
+        {
+            return _cell;
+        }
+
+        /// @return the number of bits corrected in the header of the last cell delivered
+        unsigned int correctedBits() const
+        {
+            return _correctedBits;
+        }
+
+        /// @return the state of delineation
+        DelineationState state() const
+        {
+            return _state;
+        }
+
+        /// @return the cell counts
+        Counters const& counters() const
+        {
+            return _counters;
+        }
+
+        /// Start over with hunting
+        void reset()
+        {
+            std::memset(_window, 0, sizeof(_window));
+            _pos = 0;
+            _seen = 0;
+            _reg = 0;
+            _state = DelineationHunt;
+            _fill = 0;
+            _count = 0;
+            _deliver = false;
+            _correcting = true;
+            _correctedBits = 0;
+        }
+
+    private:
+        /// HUNT: add a byte to the window, and check whether it ends a header
+        bool hunt(uint8_t data)
+        {
+            _reg = _rolling.roll(data, _window[_pos], _reg);
+            _window[_pos] = data;
+            _pos = (_pos + 1) % headerSize;
+
+            if (++_seen < headerSize || _reg != _good)
+            {
+                return false;
+            }
+
+            // The oldest byte of the window is the first one of the header
+            for (size_t j = 0; j < headerSize; ++j)
+            {
+                _cell[j] = _window[(_pos + j) % headerSize];
+            }
+
+            _state = DelineationPresync;
+            _fill = headerSize;
+            _count = 0;
+            return true;
+        }
+
+        /// PRESYNC and SYNC: check the header of the next cell
+        void checkHeader()
+        {
+            P reg = 0;
+            _algorithm.add(_cell, headerSize, reg);
+            P syndrome = reg ^ _good;
+            bool correct = static_cast<data_type>(syndrome) == 0;
+
+            if (_state == DelineationPresync)
+            {
+                if (!correct)
+                {
+                    huntFrom(reg);
+                }
+                else if (++_count == _delta)
+                {
+                    _state = DelineationSync;
+                    _count = 0;
+                }
+
+                return;
+            }
+
+            if (correct)
+            {
+                _count = 0;
+                _correcting = true;
+                _correctedBits = 0;
+                deliver();
+                return;
+            }
+
+            if (++_count == _alpha)
+            {
+                ++_counters.syncLosses;
+                huntFrom(reg);
+                return;
+            }
+
+            // Correction mode corrects a single bit error and switches to detection mode,
+            // which discards cells with errors until a header is correct again
+            if (_correct && _correcting && _corrector.correct(_cell, syndrome) == 1)
+            {
+                _correcting = false;
+                _correctedBits = 1;
+                ++_counters.corrected;
+                deliver();
+                return;
+            }
+
+            _correcting = false;
+            ++_counters.discarded;
+        }
+
+        void deliver()
+        {
+            _deliver = true;
+            ++_counters.cells;
+        }
+
+        /// Back to HUNT, continuing after the header just checked, whose rolling CRC is reg
+        void huntFrom(P const& reg)
+        {
+            std::memcpy(_window, _cell, headerSize);
+            _pos = 0;
+            _seen = headerSize;
+            _reg = reg;
+            _state = DelineationHunt;
+            _fill = 0;
+            _count = 0;
+        }
+
+        CRC<P>              _algorithm;
+        CRCRolling<P>       _rolling;
+        CRCCorrector<P>     _corrector;
+        P                   _good;          ///< the rolling CRC of a header with a correct HEC
+        bool                _correct;
+        unsigned int        _alpha;
+        unsigned int        _delta;
+
+        uint8_t             _window[headerSize];    ///< HUNT: the last bytes, as a ring
+        size_t              _pos;           ///< HUNT: the oldest byte in the window
+        size_t              _seen;          ///< HUNT: the number of bytes added to the window
+        P                   _reg;           ///< HUNT: the rolling CRC of the window
+        DelineationState    _state;
+        uint8_t             _cell[cellSize];
+        size_t              _fill;          ///< the number of bytes of the current cell so far
+        unsigned int        _count;         ///< correct HECs in PRESYNC, incorrect HECs in SYNC, in a row
+        bool                _deliver;       ///< whether the current cell is delivered
+        bool                _correcting;    ///< correction mode, as opposed to detection mode
+        unsigned int        _correctedBits;
+        Counters            _counters;
+    };
+}
@@ -0,0 +1,398 @@
+#pragma once
+/*
+ * crcbatch.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcbatch.h
+ * @brief Contains a thread pool which checks the CRCs of large batches of independent messages
+ */
+
+#include "crc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief Checks the CRCs of batches of messages on a pool of threads
+     *
+     * A job is a message which ends with its CRC, and the algorithm to check it with. The jobs of a batch
+     * are split into tasks of whole words of the result bitmap, which are dealt out to the deques of the
+     * threads. A thread takes tasks from the back of its own deque, and steals from the front of the
+     * others when it runs out, so threads which got short messages help with the long ones. Within a task,
+     * consecutive jobs of the same algorithm are added together, by the multi-buffer CRC::add().
+     *
+     * The threads live as long as the verifier. verify() may be called from several threads at once;
+     * the calling thread works on the tasks as well, until its batch is done.
+     */
+    class BatchVerifier
+    {
+    public:
+        /**
+         * An algorithm to check jobs with
+         */
+        class Algorithm
+        {
+        public:
+            virtual ~Algorithm() {}
+
+            /**
+             * Check messages which end with their CRC
+             * @param data  the messages
+             * @param len   the number of bytes in each message, including the CRC
+             * @param good  receives whether the CRC of each message is good
+             * @param count the number of messages, at most 64
+             */
+            virtual void check(uint8_t const* const* data, size_t const* len, bool* good, size_t count) const = 0;
+        };
+
+        /**
+         * A CRC with preset and invert, as used by CRCStream
+         */
+        template <class P> class Check : public Algorithm
+        {
+        public:
+            /**
+             * Constructor.
+             * @param algorithm   The CRC algorithm to use
+             * @param preset      The preset value of the CRC register
+             * @param invert      The value the CRC is inverted (xor'ed) with
+             */
+            Check(CRC<P> const& algorithm, typename P::data_type preset = ~0, typename P::data_type invert = ~0) :
+                _algorithm(algorithm),
+                _preset(preset),
+                _good(0)
+            {
+                _algorithm.add(P(invert), _good);
+            }
+
+            void check(uint8_t const* const* data, size_t const* len, bool* good, size_t count) const
+            {
+                P regs[64];
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    regs[i] = _preset;
+                }
+
+                _algorithm.add(data, len, regs, count);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    good[i] = regs[i] == _good;
+                }
+            }
+
+        private:
+            CRC<P> _algorithm;
+            P _preset;
+            P _good;    ///< the register after adding a message with a good CRC
+        };
+
+        /**
+         * A message to check
+         */
+        struct Job
+        {
+            uint8_t const* data;            ///< the message, followed by its CRC
+            size_t length;                  ///< the number of bytes, including the CRC
+            Algorithm const* algorithm;     ///< the algorithm to check the message with
+        };
+
+        /**
+         * Constructor. Starts the threads.
+         * @param threads the number of threads, 0 for one per core
+         */
+        explicit BatchVerifier(unsigned int threads = 0) :
+            _queued(0),
+            _stop(false)
+        {
+            if (threads == 0)
+            {
+                threads = std::max(1U, std::thread::hardware_concurrency());
+            }
+
+            for (unsigned int i = 0; i < threads; ++i)
+            {
+                _workers.push_back(std::unique_ptr<Worker>(new Worker));
+            }
+
+            for (unsigned int i = 0; i < threads; ++i)
+            {
+                _workers[i]->thread = std::thread(&BatchVerifier::work, this, i);
+            }
+        }
+
+        /// Destructor. Stops the threads, after the batches being verified are done.
+        ~BatchVerifier()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _stop = true;
+            }
+
+            _wake.notify_all();
+
+            for (size_t i = 0; i < _workers.size(); ++i)
+            {
+                _workers[i]->thread.join();
+            }
+        }
+
+        /**
+         * Check a batch of jobs.
+         * @param jobs  the jobs
+         * @param count the number of jobs
+         * @return the bitmap of good CRCs: bit i % 64 of word i / 64 is set if the CRC of job i is good
+         */
+        std::vector<uint64_t> verify(Job const* jobs, size_t count)
+        {
+            std::vector<uint64_t> bitmap((count + 63) / 64, 0);
+
+            if (bitmap.empty())
+            {
+                return bitmap;
+            }
+
+            // At least four tasks per thread, so there is something to steal
+            size_t threads = _workers.size();
+            size_t words = bitmap.size();
+            size_t wordsPerTask = words / (4 * threads);
+            wordsPerTask = wordsPerTask == 0 ? 1 : (wordsPerTask > maxWordsPerTask ? maxWordsPerTask : wordsPerTask);
+
+            Batch batch;
+            batch.jobs = jobs;
+            batch.count = count;
+            batch.bitmap = &bitmap[0];
+            batch.pending = (words + wordsPerTask - 1) / wordsPerTask;
+            _queued += batch.pending;
+
+            // Each thread gets a contiguous range of tasks
+            size_t first = 0;
+
+            for (size_t t = 0; t < threads; ++t)
+            {
+                size_t last = (batch.pending * (t + 1) / threads) * wordsPerTask;
+                std::lock_guard<std::mutex> lock(_workers[t]->lock);
+
+                for (; first < last && first < words; first += wordsPerTask)
+                {
+                    Task task = { &batch, first, std::min(first + wordsPerTask, words) };
+                    _workers[t]->tasks.push_back(task);
+                }
+            }
+
+            {
+                // The threads check _queued under this lock before they wait
+                std::lock_guard<std::mutex> lock(_lock);
+            }
+
+            _wake.notify_all();
+
+            // Help until the batch is done
+            std::unique_lock<std::mutex> lock(batch.lock);
+
+            while (batch.pending > 0)
+            {
+                lock.unlock();
+                Task task;
+
+                if (steal(threads, task))
+                {
+                    run(task);
+                    lock.lock();
+                }
+                else
+                {
+                    lock.lock();
+                    batch.done.wait(lock, [&batch]() { return batch.pending == 0; });
+                }
+            }
+
+            return bitmap;
+        }
+
+        /**
+         * @param bitmap the result of verify()
+         * @param job    the number of a job
+         * @return whether the CRC of the job is good
+         */
+        static bool good(std::vector<uint64_t> const& bitmap, size_t job)
+        {
+            return ((bitmap[job / 64] >> (job % 64)) & 1) != 0;
+        }
+
+        /// @return the number of threads
+        unsigned int numThreads() const
+        {
+            return static_cast<unsigned int>(_workers.size());
+        }
+
+    private:
+        /// Maximum number of bitmap words, 64 jobs each, in a task
+        static size_t const maxWordsPerTask = 16;
+
+        struct Batch
+        {
+            Job const* jobs;
+            size_t count;
+            uint64_t* bitmap;
+            size_t pending;                 ///< number of tasks not done yet, guarded by lock
+            std::mutex lock;
+            std::condition_variable done;
+        };
+
+        struct Task
+        {
+            Batch* batch;
+            size_t first;                   ///< the first bitmap word
+            size_t last;                    ///< the word after the last one
+        };
+
+        struct Worker
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        BatchVerifier(BatchVerifier const&);
+        BatchVerifier& operator = (BatchVerifier const&);
+
+        void work(size_t self)
+        {
+            for (;;)
+            {
+                Task task;
+
+                if (pop(self, task) || steal(self, task))
+                {
+                    run(task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_lock);
+                _wake.wait(lock, [this]() { return _stop || _queued > 0; });
+
+                if (_stop && _queued == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        /// Take the task which was queued last from the own deque
+        bool pop(size_t self, Task& task)
+        {
+            Worker& worker = *_workers[self];
+            std::lock_guard<std::mutex> lock(worker.lock);
+
+            if (worker.tasks.empty())
+            {
+                return false;
+            }
+
+            task = worker.tasks.back();
+            worker.tasks.pop_back();
+            --_queued;
+            return true;
+        }
+
+        /// Take the task which was queued first from the deque of another thread
+        bool steal(size_t self, Task& task)
+        {
+            for (size_t i = 1; i <= _workers.size(); ++i)
+            {
+                Worker& victim = *_workers[(self + i) % _workers.size()];
+                std::lock_guard<std::mutex> lock(victim.lock);
+
+                if (!victim.tasks.empty())
+                {
+                    task = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    --_queued;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void run(Task const& task)
+        {
+            Batch& batch = *task.batch;
+            uint8_t const* data[64];
+            size_t len[64];
+            bool good[64];
+
+            for (size_t word = task.first; word < task.last; ++word)
+            {
+                size_t first = word * 64;
+                size_t last = std::min(first + 64, batch.count);
+                uint64_t bits = 0;
+
+                // Runs of jobs with the same algorithm
+                for (size_t begin = first, end; begin < last; begin = end)
+                {
+                    Algorithm const* algorithm = batch.jobs[begin].algorithm;
+
+                    for (end = begin; end < last && batch.jobs[end].algorithm == algorithm; ++end)
+                    {
+                        data[end - begin] = batch.jobs[end].data;
+                        len[end - begin] = batch.jobs[end].length;
+                    }
+
+                    algorithm->check(data, len, good, end - begin);
+
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        bits |= static_cast<uint64_t>(good[i - begin]) << (i - first);
+                    }
+                }
+
+                batch.bitmap[word] = bits;
+            }
+
+            std::lock_guard<std::mutex> lock(batch.lock);
+
+            if (--batch.pending == 0)
+            {
+                batch.done.notify_all();
+            }
+        }
+
+        std::vector<std::unique_ptr<Worker> > _workers;
+        std::atomic<size_t> _queued;        ///< number of tasks in the deques
+        bool _stop;
+        std::mutex _lock;
+        std::condition_variable _wake;
+    };
+}
@@ -0,0 +1,204 @@
+#pragma once
+/*
+ * crccorrect.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crccorrect.h
+ * @brief Contains the correction of single and double bit errors using a CRC
+ */
+
+#include "crcstream.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief Corrects bit errors in frames of a fixed length
+     *
+     * For a frame including its CRC, the syndrome (see CRCStream::syndrome()) of an error pattern
+     * only depends on the positions of the erroneous bits, not on the data. The corrector computes the
+     * syndrome of every single bit error, and optionally of every double bit error, for one frame length
+     * and keeps them in a hash index. Correcting a frame is then a single lookup.
+     *
+     * A syndrome which belongs to more than one error pattern of the same weight is ambiguous and is
+     * not corrected. A syndrome of a single bit error is always preferred over a double bit error.
+     * Whether double bit errors can be corrected at all depends on the generator and the frame length:
+     * the code needs a Hamming distance of at least 5 for that frame length.
+     *
+     * Memory and setup time are proportional to the number of bits in the frame for single bit errors,
+     * and to its square for double bit errors.
+     */
+    template <class P> class CRCCorrector
+    {
+    public:
+        typedef typename P::data_type data_type;
+
+        /// Return value of correct() for frames which cannot be corrected
+        static int const uncorrectable = -1;
+
+        /**
+         * Constructor. Builds the index.
+         * @param algorithm   The CRC algorithm to use
+         * @param frameLength The length of the frames in bytes, including the CRC
+         * @param maxErrors   The maximum number of bit errors to correct: 1 or 2
+         */
+        CRCCorrector(CRC<P> const& algorithm, size_t frameLength, unsigned int maxErrors = 1) :
+            _frameLength(frameLength)
+        {
+            if (maxErrors < 1 || maxErrors > 2)
+            {
+                throw std::logic_error("Only single and double bit errors can be corrected");
+            }
+
+            if (frameLength == 0 || frameLength * 8 >= noPosition)
+            {
+                throw std::logic_error("Invalid frame length for error correction");
+            }
+
+            // Syndromes of all single bit errors. Walk backwards from the last byte:
+            // one more byte following the error multiplies the syndrome by X^8.
+            size_t const numBits = frameLength * 8;
+            std::vector<data_type> syndromes(numBits);
+
+            for (unsigned int bit = 0; bit < 8; ++bit)
+            {
+                P reg = 0;
+                algorithm.add(static_cast<uint8_t>(1 << bit), reg);
+
+                for (size_t byte = frameLength; byte-- > 0; )
+                {
+                    syndromes[byte * 8 + bit] = reg;
+                    algorithm.add(0, reg);
+                }
+            }
+
+            _index.reserve(maxErrors == 1 ? numBits : numBits * (numBits + 1) / 2);
+
+            for (size_t i = 0; i < numBits; ++i)
+            {
+                insert(syndromes[i], position(i, noPosition), true);
+            }
+
+            if (maxErrors == 2)
+            {
+                for (size_t i = 0; i < numBits; ++i)
+                {
+                    for (size_t j = i + 1; j < numBits; ++j)
+                    {
+                        insert(syndromes[i] ^ syndromes[j], position(i, j), false);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Correct a frame, given its syndrome
+         * @param frame    The frame, including the CRC. Corrected in place.
+         * @param syndrome The syndrome of the frame, as returned by CRCStream::syndrome()
+         * @return the number of bits corrected, 0 if the frame is good, or uncorrectable
+         */
+        int correct(uint8_t* frame, P syndrome) const
+        {
+            data_type key = syndrome;
+
+            if (key == 0)
+            {
+                return 0;
+            }
+
+            typename Index::const_iterator it = _index.find(key);
+
+            if (it == _index.end() || it->second == ambiguous)
+            {
+                return uncorrectable;
+            }
+
+            flip(frame, it->second & noPosition);
+
+            if ((it->second >> 32) == noPosition)
+            {
+                return 1;
+            }
+
+            flip(frame, it->second >> 32);
+            return 2;
+        }
+
+        /**
+         * Check a frame and correct it if necessary
+         * @param stream The CRCStream to check with. It must use the same algorithm as the corrector.
+         * @param frame  The frame, including the CRC. Its length is the one given to the constructor. Corrected in place.
+         * @return the number of bits corrected, 0 if the frame is good, or uncorrectable
+         */
+        int correct(CRCStream<P>& stream, uint8_t* frame) const
+        {
+            stream.process(frame, _frameLength);
+            return correct(frame, stream.syndrome());
+        }
+
+        /// @return the frame length in bytes
+        size_t frameLength() const
+        {
+            return _frameLength;
+        }
+
+    private:
+        typedef std::unordered_map<data_type, uint64_t> Index;
+
+        // Positions are packed into 32 bits each, the first one in the low half
+        static uint64_t const noPosition = 0xFFFFFFFFULL;
+        static uint64_t const ambiguous = ~0ULL;
+
+        static uint64_t position(size_t first, uint64_t second)
+        {
+            return static_cast<uint64_t>(first) | (second << 32);
+        }
+
+        static void flip(uint8_t* frame, uint64_t bit)
+        {
+            frame[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        }
+
+        void insert(data_type syndrome, uint64_t positions, bool single)
+        {
+            std::pair<typename Index::iterator, bool> result = _index.insert(std::make_pair(syndrome, positions));
+
+            if (!result.second && result.first->second != ambiguous)
+            {
+                bool existingSingle = (result.first->second >> 32) == noPosition;
+
+                // A single bit error is more likely than a double bit error. Singles are inserted first,
+                // so an ambiguous entry stems from two singles and stays ambiguous.
+                if (single || !existingSingle)
+                {
+                    result.first->second = single && !existingSingle ? positions : ambiguous;
+                }
+            }
+        }
+
+        size_t  _frameLength;
+        Index   _index;
+    };
+}
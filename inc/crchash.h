@@ -0,0 +1,197 @@
+#pragma once
+/*
+ * crchash.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crchash.h
+ * @brief Contains a hash function object based on a CRC, for hash tables and for hashing columns of keys
+ */
+
+#include "crc.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief CRC-32C (Castagnoli), which most x86 CPUs compute with the crc32 instruction
+     */
+    struct CRC32C
+    {
+        typedef Poly32N poly_type;
+        static poly_type generator()
+        {
+            return 0x82F63B78;
+        }
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief CRC-32 of IEEE 802.3 (Ethernet, zip)
+     */
+    struct CRC32
+    {
+        typedef Poly32N poly_type;
+        static poly_type generator()
+        {
+            return 0xEDB88320;
+        }
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief CRC-64 of ECMA-182 in network order (xz)
+     */
+    struct CRC64
+    {
+        typedef Poly64N poly_type;
+        static poly_type generator()
+        {
+            return 0xC96C5795D7870F42ULL;
+        }
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief Hash function object computing the CRC of a key
+     *
+     * The hash of a key is its CRC with a preset of all ones and an inverted result, so with the
+     * default seed crc_hash<CRC32C>()(key) is the standard CRC-32C of the key. Another seed replaces the preset.
+     * The algorithm is one of CRC32C, CRC32 and CRC64, or any type which provides the polynomial type
+     * as poly_type and the generator polynomial as generator(). Its tables are built once per algorithm,
+     * on first use, and shared by all hash objects, so the hash objects are cheap to construct and to copy,
+     * as std::unordered_map expects.
+     *
+     * Columns of keys are hashed with hashColumn(), which adds several keys at a time (see CRC::add()
+     * for several buffers).
+     */
+    template <class Algorithm = CRC32C> class crc_hash
+    {
+    public:
+        typedef typename Algorithm::poly_type poly_type;
+
+        /**
+         * Constructor.
+         * @param seed   The preset of the CRC register
+         */
+        explicit crc_hash(uint64_t seed = ~0ULL) :
+            _preset(static_cast<data_type>(seed))
+        {
+        }
+
+        /**
+         * Hash a number of bytes.
+         * @param data the key
+         * @param len  the number of bytes in the key
+         * @return the hash
+         */
+        size_t operator()(void const* data, size_t len) const
+        {
+            P reg = _preset;
+            algorithm().add(static_cast<uint8_t const*>(data), len, reg);
+            return result(reg);
+        }
+
+        /// @return the hash of a string
+        size_t operator()(std::string const& key) const
+        {
+            return (*this)(key.data(), key.size());
+        }
+
+        /// @return the hash of a string
+        size_t operator()(char const* key) const
+        {
+            return (*this)(key, std::strlen(key));
+        }
+
+        /// @return the hash of a number, from its bytes in memory
+        template <class T> typename std::enable_if<std::is_arithmetic<T>::value, size_t>::type operator()(T key) const
+        {
+            uint8_t bytes[sizeof(T)];
+            std::memcpy(bytes, &key, sizeof(T));
+
+            P reg = _preset;
+            algorithm().add(bytes, reg);
+            return result(reg);
+        }
+
+        /**
+         * Hash a column of keys of variable length, which are stored one after the other,
+         * as in Apache Arrow: key i has the bytes data[offsets[i]] up to, but not including, data[offsets[i + 1]].
+         * @param data    the bytes of all keys
+         * @param offsets the offsets of the keys in data, count + 1 of them
+         * @param count   the number of keys
+         * @param hashes  receives the count hashes
+         */
+        template <class O> void hashColumn(uint8_t const* data, O const* offsets, size_t count, size_t* hashes) const
+        {
+            CRC<P> const& crc = algorithm();
+            uint8_t const* keys[batchSize];
+            size_t lengths[batchSize];
+            P regs[batchSize];
+
+            for (size_t first = 0; first < count; first += batchSize)
+            {
+                size_t n = count - first < batchSize ? count - first : batchSize;
+
+                for (size_t i = 0; i < n; ++i)
+                {
+                    keys[i] = data + offsets[first + i];
+                    lengths[i] = static_cast<size_t>(offsets[first + i + 1] - offsets[first + i]);
+                    regs[i] = _preset;
+                }
+
+                crc.add(keys, lengths, regs, n);
+
+                for (size_t i = 0; i < n; ++i)
+                {
+                    hashes[first + i] = result(regs[i]);
+                }
+            }
+        }
+
+        /// @return the CRC algorithm shared by all hash objects of this type
+        static CRC<poly_type> const& algorithm()
+        {
+            static CRC<poly_type> const crc(Algorithm::generator());
+            return crc;
+        }
+
+    private:
+        typedef poly_type P;
+        typedef typename P::data_type data_type;
+
+        /// Number of keys passed to CRC::add() at a time
+        static size_t const batchSize = 64;
+
+        static size_t result(P const& reg)
+        {
+            return static_cast<size_t>(static_cast<data_type>(~reg));
+        }
+
+        P _preset;
+    };
+}
@@ -0,0 +1,413 @@
+#pragma once
+/*
+ * crchdlc.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crchdlc.h
+ * @brief Contains the encoder and decoder for asynchronous HDLC framing (RFC 1662), which compute the FCS on the fly
+ */
+
+#include "crc.h"
+#include "crcstream.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * The outcome of decoding a frame
+     * @ingroup CRCpp
+     */
+    enum FrameStatus
+    {
+        FrameGood,          ///< the FCS is good
+        FrameBadFCS,        ///< the FCS is bad
+        FrameAborted,       ///< the frame ended with the abort sequence 0x7D 0x7E
+        FrameTooShort,      ///< the frame is shorter than its FCS
+        FrameTooLong        ///< the frame is longer than the maximum size of the decoder
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief The octet stuffing of asynchronous HDLC, shared by the encoder and the decoder
+     *
+     * Frames are delimited by flags (0x7E). Flags and escapes (0x7D) within a frame, and the control
+     * characters selected by the async control character map (ACCM), are sent as an escape followed by
+     * the character xor 0x20.
+     */
+    class HDLCFraming
+    {
+    public:
+        static uint8_t const flag = 0x7E;
+        static uint8_t const escape = 0x7D;
+        static uint8_t const flip = 0x20;
+
+        /**
+         * Find the next byte which is not part of an escape free run.
+         * @param data     the bytes to scan
+         * @param len      the number of bytes
+         * @param controls whether control characters (below 0x20) end the run as well
+         * @return the offset of the first flag, escape or control character, len if there is none
+         */
+        static size_t scan(uint8_t const* data, size_t len, bool controls)
+        {
+            size_t i = 0;
+
+#if defined (CRCPP_HAVE_SSE2)
+            __m128i const flags = _mm_set1_epi8(static_cast<char>(flag));
+            __m128i const escapes = _mm_set1_epi8(static_cast<char>(escape));
+            __m128i const lastControl = _mm_set1_epi8(static_cast<char>(controls ? flip - 1 : 0));
+
+            for (; i + 16 <= len; i += 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+                __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, flags), _mm_cmpeq_epi8(v, escapes));
+
+                if (controls)
+                {
+                    // Unsigned v <= 0x1F
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(v, lastControl), v));
+                }
+
+                if (_mm_movemask_epi8(special) != 0)
+                {
+                    break;
+                }
+            }
+
+#endif
+
+            for (; i < len; ++i)
+            {
+                if (data[i] == flag || data[i] == escape || (controls && data[i] < flip))
+                {
+                    return i;
+                }
+            }
+
+            return len;
+        }
+
+        /**
+         * @param data the byte
+         * @param accm the async control character map: bit i set to escape character i
+         * @return whether the byte has to be escaped
+         */
+        static bool needsEscape(uint8_t data, uint32_t accm)
+        {
+            return data == flag || data == escape || (data < flip && ((accm >> data) & 1) != 0);
+        }
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief Encodes frames for asynchronous HDLC, as used by PPP (RFC 1662)
+     *
+     * The FCS is computed while the frame is stuffed: runs of bytes which need no escape are copied
+     * and added to the CRC in the same pass by CRC::copyAndAdd(), only the bytes in between are handled one by one.
+     * The FCS is the CRC with preset and invert, as computed by CRCStream, in the byte order of CRCResult.
+     * PPP uses CRC-CCITT in network order (FCS-16) or the CRC of IEEE 802.3 (FCS-32).
+     */
+    template <class P> class HDLCEncoder
+    {
+    public:
+        typedef typename P::data_type data_type;
+
+        /**
+         * Constructor.
+         * @param algorithm   The CRC algorithm to use
+         * @param accm        The async control character map: bit i set to escape character i. By default, all are escaped.
+         * @param preset      The preset value of the CRC register
+         * @param invert      The value the CRC is inverted (xor'ed) with
+         */
+        HDLCEncoder(CRC<P> const& algorithm, uint32_t accm = 0xFFFFFFFF, data_type preset = ~0, data_type invert = ~0) :
+            _algorithm(algorithm),
+            _accm(accm),
+            _preset(preset),
+            _invert(invert)
+        {
+        }
+
+        /**
+         * @param len the number of bytes in a frame
+         * @return the maximum number of bytes encode() writes for the frame
+         */
+        static size_t maxEncodedSize(size_t len)
+        {
+            return 2 * (len + sizeof(data_type)) + 2;
+        }
+
+        /**
+         * Encode a frame: the opening flag, the stuffed data and FCS, and the closing flag.
+         * @param data the frame, without FCS
+         * @param len  the number of bytes in the frame
+         * @param out  receives the encoded frame. Must have room for maxEncodedSize(len) bytes.
+         * @return the number of bytes written to out
+         */
+        size_t encode(uint8_t const* data, size_t len, uint8_t* out) const
+        {
+            uint8_t* pos = out;
+            P reg = _preset;
+            *pos++ = HDLCFraming::flag;
+
+            for (size_t i = 0; i < len; )
+            {
+                size_t run = HDLCFraming::scan(data + i, len - i, _accm != 0);
+                _algorithm.copyAndAdd(pos, data + i, run, reg);
+                pos += run;
+                i += run;
+
+                if (i < len)
+                {
+                    _algorithm.add(data[i], reg);
+                    pos = stuff(data[i++], pos);
+                }
+            }
+
+            CRCResult<P> fcs(static_cast<data_type>(reg ^ _invert));
+
+            for (size_t i = 0; i < fcs.size(); ++i)
+            {
+                pos = stuff(fcs.c_str()[i], pos);
+            }
+
+            *pos++ = HDLCFraming::flag;
+            return static_cast<size_t>(pos - out);
+        }
+
+        /**
+         * Encode a frame and append it to a vector.
+         * @param data the frame, without FCS
+         * @param len  the number of bytes in the frame
+         * @param out  the encoded frame is appended to it
+         */
+        void encode(uint8_t const* data, size_t len, std::vector<uint8_t>& out) const
+        {
+            size_t size = out.size();
+            out.resize(size + maxEncodedSize(len));
+            out.resize(size + encode(data, len, &out[size]));
+        }
+
+    private:
+        uint8_t* stuff(uint8_t data, uint8_t* pos) const
+        {
+            if (HDLCFraming::needsEscape(data, _accm))
+            {
+                *pos++ = HDLCFraming::escape;
+                data = static_cast<uint8_t>(data ^ HDLCFraming::flip);
+            }
+
+            *pos++ = data;
+            return pos;
+        }
+
+        CRC<P>      _algorithm;
+        uint32_t    _accm;
+        data_type   _preset;
+        data_type   _invert;
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief Decodes asynchronous HDLC frames, as used by PPP (RFC 1662), and checks their FCS
+     *
+     * Unstuffing and checking the FCS is done in a single pass: the bytes between flags and escapes
+     * are found 16 at a time with SSE2, and each escape free run is copied to the frame and added to the CRC
+     * by CRC::copyAndAdd(). The FCS is added as well, so a frame is good if the register ends up with
+     * the residue of a good frame.
+     *
+     * Data before the first flag is discarded, since it may be the tail of a frame whose start was missed.
+     * Empty frames, i.e. consecutive flags, are skipped.
+     */
+    template <class P> class HDLCDecoder
+    {
+    public:
+        typedef typename P::data_type data_type;
+
+        /**
+         * Constructor.
+         * @param algorithm   The CRC algorithm to use
+         * @param maxSize     The maximum size of a frame, including the FCS
+         * @param preset      The preset value of the CRC register
+         * @param invert      The value the CRC is inverted (xor'ed) with
+         */
+        HDLCDecoder(CRC<P> const& algorithm, size_t maxSize = 65536, data_type preset = ~0, data_type invert = ~0) :
+            _algorithm(algorithm),
+            _buffer(maxSize),
+            _preset(preset),
+            _good(0),
+            _status(FrameGood),
+            _size(0)
+        {
+            _algorithm.add(P(invert), _good);
+            reset();
+        }
+
+        /**
+         * Decode data up to the end of the next frame.
+         * @param data the data to decode
+         * @param len  the number of bytes in data
+         * @return the number of bytes of data up to and including the flag which ends a frame, or 0 if no frame
+         *         ends within data. In that case all of data has been decoded, and decoding continues with the next call.
+         *         Otherwise, the frame is available through status(), frame() and size() until the next call.
+         */
+        size_t next(uint8_t const* data, size_t len)
+        {
+            size_t i = 0;
+
+            while (i < len)
+            {
+                if (_escaped && data[i] != HDLCFraming::flag)
+                {
+                    append(static_cast<uint8_t>(data[i++] ^ HDLCFraming::flip));
+                    _escaped = false;
+                    continue;
+                }
+
+                size_t run = HDLCFraming::scan(data + i, len - i, false);
+                append(data + i, run);
+                i += run;
+
+                if (i == len)
+                {
+                    break;
+                }
+
+                if (data[i++] == HDLCFraming::escape)
+                {
+                    _escaped = true;
+                }
+                else if (endFrame())
+                {
+                    return i;
+                }
+            }
+
+            return 0;
+        }
+
+        /// @return the status of the last frame
+        FrameStatus status() const
+        {
+            return _status;
+        }
+
+        /// @return whether the last frame is good
+        bool good() const
+        {
+            return _status == FrameGood;
+        }
+
+        /// @return the bytes of the last frame, without FCS
+        uint8_t const* frame() const
+        {
+            return _buffer.empty() ? 0 : &_buffer[0];
+        }
+
+        /// @return the number of bytes of the last frame, without FCS. 0 if it was aborted, too short or too long.
+        size_t size() const
+        {
+            return _size;
+        }
+
+        /// Start over: discard the frame being decoded, and wait for the next flag
+        void reset()
+        {
+            _hunting = true;
+            _escaped = false;
+            _overrun = false;
+            _length = 0;
+            _reg = _preset;
+        }
+
+    private:
+        void append(uint8_t const* data, size_t len)
+        {
+            if (_hunting || len == 0)
+            {
+                return;
+            }
+
+            if (len > _buffer.size() - _length)
+            {
+                _overrun = true;
+                return;
+            }
+
+            _algorithm.copyAndAdd(&_buffer[_length], data, len, _reg);
+            _length += len;
+        }
+
+        void append(uint8_t data)
+        {
+            append(&data, 1);
+        }
+
+        /// At a flag: finish the frame, if there is one
+        bool endFrame()
+        {
+            bool hunting = _hunting;
+            bool empty = _length == 0 && !_escaped && !_overrun;
+
+            if (!hunting && !empty)
+            {
+                _size = 0;
+
+                if (_escaped)
+                {
+                    _status = FrameAborted;
+                }
+                else if (_overrun)
+                {
+                    _status = FrameTooLong;
+                }
+                else if (_length < sizeof(data_type))
+                {
+                    _status = FrameTooShort;
+                }
+                else
+                {
+                    _status = _reg == _good ? FrameGood : FrameBadFCS;
+                    _size = _length - sizeof(data_type);
+                }
+            }
+
+            // The flag opens the next frame
+            reset();
+            _hunting = false;
+            return !hunting && !empty;
+        }
+
+        CRC<P>                  _algorithm;
+        std::vector<uint8_t>    _buffer;
+        P                       _preset;
+        P                       _good;      ///< the register after adding a frame with a good FCS
+        P                       _reg;
+        bool                    _hunting;   ///< no flag seen yet
+        bool                    _escaped;   ///< the last byte was an escape
+        bool                    _overrun;   ///< the frame does not fit into the buffer
+        size_t                  _length;    ///< the number of bytes of the frame so far
+        FrameStatus             _status;
+        size_t                  _size;
+    };
+}
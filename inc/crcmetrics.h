@@ -0,0 +1,692 @@
+#pragma once
+/*
+ * crcmetrics.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcmetrics.h
+ * @brief Contains the runtime metrics of CRC++ and their export as Prometheus text or JSON
+ */
+
+#include "crc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * Runtime metrics of the CRC calculations: bytes and calls per algorithm and kernel, histograms of
+     * the data size and latency of calls, and the results of CRCStream::good() and check()
+     * @ingroup CRCpp
+     *
+     * Metrics are off by default. While they are off, a call costs a test of the MetricsHook. While they are on,
+     * each thread counts into its own counters, without locks or atomic read-modify-write operations, and
+     * the counters of all threads, including those which have ended, are added up by snapshot().
+     *
+     * Calls of the bulk add(), copyAndAdd(), and the add() of several buffers, of scatter/gather lists and of
+     * fixed size blocks are counted. So are the byte sequences, strings and byte vectors which CRCStream adds,
+     * generates or checks. Single bytes, bits and other collections, which are added one at a time, are not.
+     * Reading the clock costs more than adding a short buffer, so the latency is measured for a random sample
+     * of one call in latencySampling. Each buffer of a call with several buffers gets an equal share of its time.
+     */
+    class CRCMetrics
+    {
+    public:
+        /// The number of buckets of the size histogram: up to 16, 64, 256 ... 256K bytes, and more
+        static size_t const numSizeBuckets = 9;
+
+        /// The number of buckets of the latency histogram: up to 64, 256 ns, 1 ... 1024 us, and more
+        static size_t const numLatencyBuckets = 9;
+
+        /// One call in this many is timed, on average
+        static unsigned int const latencySampling = 16;
+
+        /**
+         * A CRC algorithm, identified by its generator polynomial
+         */
+        struct Algorithm
+        {
+            uint64_t generator;
+            unsigned int bits;
+            bool reflected;
+
+            bool operator < (Algorithm const& other) const
+            {
+                return generator != other.generator ? generator < other.generator :
+                       (bits != other.bits ? bits < other.bits : reflected < other.reflected);
+            }
+
+            bool operator == (Algorithm const& other) const
+            {
+                return generator == other.generator && bits == other.bits && reflected == other.reflected;
+            }
+        };
+
+        /**
+         * The counts of a kernel
+         */
+        struct Counts
+        {
+            uint64_t bytes;
+            uint64_t calls;
+            uint64_t sizes[numSizeBuckets];         ///< calls by size, see sizeBucket()
+            uint64_t latencies[numLatencyBuckets];  ///< timed calls by latency, see latencyBucket()
+            uint64_t nanoseconds;                   ///< the sum of the latencies of timed calls
+        };
+
+        /**
+         * The counts of an algorithm
+         */
+        struct AlgorithmCounts
+        {
+            Counts kernels[numKernels];
+            uint64_t good;                          ///< good results of CRCStream
+            uint64_t bad;                           ///< bad results of CRCStream
+            std::string name;                       ///< see setName()
+        };
+
+        typedef std::map<Algorithm, AlgorithmCounts> Snapshot;
+
+        /// @return whether metrics are recorded
+        static bool enabled()
+        {
+            return MetricsHook::get() != 0;
+        }
+
+        /**
+         * Start or stop recording metrics. The counts recorded so far are kept.
+         * @param on whether to record metrics
+         */
+        static void enable(bool on = true)
+        {
+            MetricsHook::set(on ? &Recorder::get() : 0);
+        }
+
+        /**
+         * @param generator the generator polynomial
+         * @return the algorithm of the generator polynomial
+         */
+        template <class P> static Algorithm algorithm(P const generator)
+        {
+            Algorithm a = { static_cast<uint64_t>(static_cast<typename P::data_type>(generator)), P::numbits, P::reflected };
+            return a;
+        }
+
+        /**
+         * Name an algorithm, for the export of metrics
+         * @param a    the algorithm
+         * @param name the name, e.g. "ieee802.3"
+         */
+        static void setName(Algorithm const& a, std::string const& name)
+        {
+            Registry& registry = Registry::get();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            registry.names[a] = name;
+        }
+
+        /**
+         * Record a call
+         * @param a           the algorithm
+         * @param kernel      the kernel
+         * @param len         the number of bytes
+         * @param nanoseconds the latency, or untimed
+         */
+        static void record(Algorithm const& a, Kernel kernel, size_t len, uint64_t nanoseconds)
+        {
+            Counters& counters = local().find(a).kernels[kernel];
+            bump(counters.bytes, len);
+            bump(counters.calls, 1);
+            bump(counters.sizes[sizeBucket(len)], 1);
+
+            if (nanoseconds != MetricsHook::untimed)
+            {
+                bump(counters.latencies[latencyBucket(nanoseconds)], 1);
+                bump(counters.nanoseconds, nanoseconds);
+            }
+        }
+
+        /**
+         * Record the result of checking a CRC
+         * @param a    the algorithm
+         * @param good whether the CRC is good
+         */
+        static void recordResult(Algorithm const& a, bool good)
+        {
+            AlgorithmCounters& counters = local().find(a);
+            bump(good ? counters.good : counters.bad, 1);
+        }
+
+        /// @return the counts of all threads, for each algorithm
+        static Snapshot snapshot()
+        {
+            Registry& registry = Registry::get();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            Snapshot snapshot = registry.retired;
+
+            for (size_t i = 0; i < registry.threads.size(); ++i)
+            {
+                registry.threads[i]->addTo(snapshot);
+            }
+
+            for (std::map<Algorithm, std::string>::const_iterator it = registry.names.begin(); it != registry.names.end(); ++it)
+            {
+                Snapshot::iterator s = snapshot.find(it->first);
+
+                if (s != snapshot.end())
+                {
+                    s->second.name = it->second;
+                }
+            }
+
+            return snapshot;
+        }
+
+        /// @return the size bucket of len bytes
+        static size_t sizeBucket(size_t len)
+        {
+            size_t bucket = 0;
+
+            for (size_t limit = 16; bucket + 1 < numSizeBuckets && len > limit; limit *= 4)
+            {
+                ++bucket;
+            }
+
+            return bucket;
+        }
+
+        /// @return the upper bound of a size bucket, 0 for the last one
+        static uint64_t sizeLimit(size_t bucket)
+        {
+            return bucket + 1 < numSizeBuckets ? static_cast<uint64_t>(16) << (2 * bucket) : 0;
+        }
+
+        /// @return the latency bucket of a call which took nanoseconds
+        static size_t latencyBucket(uint64_t nanoseconds)
+        {
+            size_t bucket = 0;
+
+            for (uint64_t limit = 64; bucket + 1 < numLatencyBuckets && nanoseconds > limit; limit *= 4)
+            {
+                ++bucket;
+            }
+
+            return bucket;
+        }
+
+        /// @return the upper bound of a latency bucket in nanoseconds, 0 for the last one
+        static uint64_t latencyLimit(size_t bucket)
+        {
+            return bucket + 1 < numLatencyBuckets ? static_cast<uint64_t>(64) << (2 * bucket) : 0;
+        }
+
+    private:
+        // Only the own thread writes the counters, others read them for a snapshot
+        typedef std::atomic<uint64_t> Counter;
+
+        struct Counters
+        {
+            Counter bytes;
+            Counter calls;
+            Counter sizes[numSizeBuckets];
+            Counter latencies[numLatencyBuckets];
+            Counter nanoseconds;
+        };
+
+        struct AlgorithmCounters
+        {
+            Counters kernels[numKernels];
+            Counter good;
+            Counter bad;
+        };
+
+        class ThreadCounters;
+
+        struct Registry
+        {
+            std::mutex lock;
+            std::vector<ThreadCounters*> threads;
+            Snapshot retired;                       ///< the counts of threads which have ended
+            std::map<Algorithm, std::string> names;
+
+            static Registry& get()
+            {
+                static Registry registry;
+                return registry;
+            }
+        };
+
+        class ThreadCounters
+        {
+        public:
+            ThreadCounters() :
+                _last(0),
+                _random(static_cast<uint32_t>(reinterpret_cast<size_t>(this) >> 4) | 1)
+            {
+                Registry& registry = Registry::get();
+                std::lock_guard<std::mutex> lock(registry.lock);
+                registry.threads.push_back(this);
+            }
+
+            ~ThreadCounters()
+            {
+                Registry& registry = Registry::get();
+                std::lock_guard<std::mutex> lock(registry.lock);
+                addTo(registry.retired);
+                registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+            }
+
+            /// @return the counters of an algorithm, created on first use
+            AlgorithmCounters& find(Algorithm const& a)
+            {
+                if (_last != 0 && _lastAlgorithm == a)
+                {
+                    return *_last;
+                }
+
+                // Only this thread inserts, so it can look up without the lock
+                std::map<Algorithm, std::unique_ptr<AlgorithmCounters> >::iterator it = _algorithms.find(a);
+
+                if (it == _algorithms.end())
+                {
+                    std::unique_ptr<AlgorithmCounters> counters(new AlgorithmCounters());
+                    std::lock_guard<std::mutex> lock(_lock);
+                    it = _algorithms.insert(std::make_pair(a, std::move(counters))).first;
+                }
+
+                _lastAlgorithm = a;
+                _last = it->second.get();
+                return *_last;
+            }
+
+            /// @return whether to time the next call: randomly, so calls which alternate are sampled alike
+            bool sample()
+            {
+                // xorshift32
+                _random ^= _random << 13;
+                _random ^= _random >> 17;
+                _random ^= _random << 5;
+                return _random % latencySampling == 0;
+            }
+
+            /// Add the counts of this thread to a snapshot
+            void addTo(Snapshot& snapshot)
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+
+                for (std::map<Algorithm, std::unique_ptr<AlgorithmCounters> >::const_iterator it = _algorithms.begin(); it != _algorithms.end(); ++it)
+                {
+                    AlgorithmCounts& counts = snapshot[it->first];
+                    counts.good += it->second->good.load(std::memory_order_relaxed);
+                    counts.bad += it->second->bad.load(std::memory_order_relaxed);
+
+                    for (size_t k = 0; k < numKernels; ++k)
+                    {
+                        Counters const& from = it->second->kernels[k];
+                        Counts& to = counts.kernels[k];
+                        to.bytes += from.bytes.load(std::memory_order_relaxed);
+                        to.calls += from.calls.load(std::memory_order_relaxed);
+                        to.nanoseconds += from.nanoseconds.load(std::memory_order_relaxed);
+
+                        for (size_t b = 0; b < numSizeBuckets; ++b)
+                        {
+                            to.sizes[b] += from.sizes[b].load(std::memory_order_relaxed);
+                        }
+
+                        for (size_t b = 0; b < numLatencyBuckets; ++b)
+                        {
+                            to.latencies[b] += from.latencies[b].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::mutex _lock;                       ///< guards the map against inserts during a snapshot
+            std::map<Algorithm, std::unique_ptr<AlgorithmCounters> > _algorithms;
+            Algorithm _lastAlgorithm;
+            AlgorithmCounters* _last;               ///< the counters of the algorithm used last
+            uint32_t _random;                       ///< the state of the sampling of latencies
+        };
+
+        /// Records the calls reported by CRC and CRCStream
+        class Recorder :
+            public MetricsHook
+        {
+        public:
+            static Recorder& get()
+            {
+                static Recorder recorder;
+                return recorder;
+            }
+
+            virtual uint64_t start()
+            {
+                return local().sample() ? now() : untimed;
+            }
+
+            virtual uint64_t elapsed(uint64_t start)
+            {
+                return start != untimed ? now() - start : untimed;
+            }
+
+            virtual void record(uint64_t generator, unsigned int bits, bool reflected, Kernel kernel, size_t len, uint64_t nanoseconds)
+            {
+                Algorithm a = { generator, bits, reflected };
+                CRCMetrics::record(a, kernel, len, nanoseconds);
+            }
+
+            virtual void recordResult(uint64_t generator, unsigned int bits, bool reflected, bool good)
+            {
+                Algorithm a = { generator, bits, reflected };
+                CRCMetrics::recordResult(a, good);
+            }
+
+        private:
+            static uint64_t now()
+            {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+            }
+        };
+
+        static ThreadCounters& local()
+        {
+            static thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        /// Add to a counter which only this thread writes: no need for an atomic read-modify-write
+        static void bump(Counter& counter, uint64_t n)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+
+    /**
+     * @ingroup CRCpp
+     * @brief Writes the runtime metrics of CRC++
+     *
+     * An algorithm is labeled with its name, see CRCMetrics::setName(), or with its width, bit order
+     * and generator polynomial, e.g. "32N EDB88320" for the CRC of IEEE 802.3. Kernels which have not
+     * been used are left out.
+     */
+    class MetricsWriter
+    {
+    public:
+        /**
+         * Write the metrics in the Prometheus text exposition format.
+         * Counters: crcpp_bytes_total, crcpp_calls_total (by algorithm and kernel), crcpp_checks_total
+         * (by algorithm and result). Histograms: crcpp_message_size_bytes, crcpp_latency_seconds (of the sampled calls).
+         * @param s        the stream to write to
+         * @param snapshot the metrics
+         */
+        static void writePrometheus(std::ostream& s, CRCMetrics::Snapshot const& snapshot)
+        {
+            typedef CRCMetrics::Snapshot::const_iterator iterator;
+
+            s << "# HELP crcpp_bytes_total Bytes added to CRCs." << std::endl;
+            s << "# TYPE crcpp_bytes_total counter" << std::endl;
+
+            for (iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    if (it->second.kernels[k].calls != 0)
+                    {
+                        s << "crcpp_bytes_total" << labels(*it, k) << "} " << it->second.kernels[k].bytes << std::endl;
+                    }
+                }
+            }
+
+            s << "# HELP crcpp_calls_total Calls which added data to CRCs." << std::endl;
+            s << "# TYPE crcpp_calls_total counter" << std::endl;
+
+            for (iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    if (it->second.kernels[k].calls != 0)
+                    {
+                        s << "crcpp_calls_total" << labels(*it, k) << "} " << it->second.kernels[k].calls << std::endl;
+                    }
+                }
+            }
+
+            s << "# HELP crcpp_message_size_bytes Bytes added by a call." << std::endl;
+            s << "# TYPE crcpp_message_size_bytes histogram" << std::endl;
+
+            for (iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    CRCMetrics::Counts const& counts = it->second.kernels[k];
+
+                    if (counts.calls == 0)
+                    {
+                        continue;
+                    }
+
+                    uint64_t cumulative = 0;
+
+                    for (size_t b = 0; b < CRCMetrics::numSizeBuckets; ++b)
+                    {
+                        cumulative += counts.sizes[b];
+                        uint64_t limit = CRCMetrics::sizeLimit(b);
+                        s << "crcpp_message_size_bytes_bucket" << labels(*it, k) << ",le=\"";
+                        (limit != 0 ? s << limit : s << "+Inf") << "\"} " << cumulative << std::endl;
+                    }
+
+                    s << "crcpp_message_size_bytes_sum" << labels(*it, k) << "} " << counts.bytes << std::endl;
+                    s << "crcpp_message_size_bytes_count" << labels(*it, k) << "} " << counts.calls << std::endl;
+                }
+            }
+
+            s << "# HELP crcpp_latency_seconds Time of a call, for a sample of the calls." << std::endl;
+            s << "# TYPE crcpp_latency_seconds histogram" << std::endl;
+            std::streamsize precision = s.precision(10);
+
+            for (iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    CRCMetrics::Counts const& counts = it->second.kernels[k];
+
+                    if (counts.calls == 0)
+                    {
+                        continue;
+                    }
+
+                    uint64_t cumulative = 0;
+
+                    for (size_t b = 0; b < CRCMetrics::numLatencyBuckets; ++b)
+                    {
+                        cumulative += counts.latencies[b];
+                        uint64_t limit = CRCMetrics::latencyLimit(b);
+                        s << "crcpp_latency_seconds_bucket" << labels(*it, k) << ",le=\"";
+                        (limit != 0 ? s << limit / 1e9 : s << "+Inf") << "\"} " << cumulative << std::endl;
+                    }
+
+                    s << "crcpp_latency_seconds_sum" << labels(*it, k) << "} " << counts.nanoseconds / 1e9 << std::endl;
+                    s << "crcpp_latency_seconds_count" << labels(*it, k) << "} " << cumulative << std::endl;
+                }
+            }
+
+            s.precision(precision);
+            s << "# HELP crcpp_checks_total Results of checking CRCs." << std::endl;
+            s << "# TYPE crcpp_checks_total counter" << std::endl;
+
+            for (iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                if (it->second.good + it->second.bad != 0)
+                {
+                    s << "crcpp_checks_total" << labels(*it, -1) << ",result=\"good\"} " << it->second.good << std::endl;
+                    s << "crcpp_checks_total" << labels(*it, -1) << ",result=\"bad\"} " << it->second.bad << std::endl;
+                }
+            }
+        }
+
+        /**
+         * Write the metrics as a JSON object. The histograms are arrays of counts for the buckets of
+         * size_buckets and latency_buckets_ns, which hold their upper bounds; the last bucket holds the rest.
+         * Latencies and nanoseconds are those of the sampled calls, one in latency_sampling.
+         * @param s        the stream to write to
+         * @param snapshot the metrics
+         */
+        static void writeJSON(std::ostream& s, CRCMetrics::Snapshot const& snapshot)
+        {
+            s << "{" << std::endl << "  \"latency_sampling\": " << CRCMetrics::latencySampling << "," << std::endl << "  \"size_buckets\": [";
+
+            for (size_t b = 0; b + 1 < CRCMetrics::numSizeBuckets; ++b)
+            {
+                s << (b == 0 ? "" : ", ") << CRCMetrics::sizeLimit(b);
+            }
+
+            s << "]," << std::endl << "  \"latency_buckets_ns\": [";
+
+            for (size_t b = 0; b + 1 < CRCMetrics::numLatencyBuckets; ++b)
+            {
+                s << (b == 0 ? "" : ", ") << CRCMetrics::latencyLimit(b);
+            }
+
+            s << "]," << std::endl << "  \"algorithms\": [";
+            char const* separator = "";
+
+            for (CRCMetrics::Snapshot::const_iterator it = snapshot.begin(); it != snapshot.end(); ++it)
+            {
+                CRCMetrics::AlgorithmCounts const& counts = it->second;
+                s << separator << std::endl << "    {" << std::endl;
+                s << "      \"algorithm\": \"" << escape(name(*it)) << "\"," << std::endl;
+                s << "      \"bits\": " << it->first.bits << "," << std::endl;
+                s << "      \"order\": \"" << (it->first.reflected ? "network" : "native") << "\"," << std::endl;
+                s << "      \"generator\": \"" << generator(it->first) << "\"," << std::endl;
+                s << "      \"good\": " << counts.good << "," << std::endl;
+                s << "      \"bad\": " << counts.bad << "," << std::endl;
+                s << "      \"kernels\": [";
+                char const* kernelSeparator = "";
+
+                for (int k = 0; k < numKernels; ++k)
+                {
+                    CRCMetrics::Counts const& kernel = counts.kernels[k];
+
+                    if (kernel.calls == 0)
+                    {
+                        continue;
+                    }
+
+                    s << kernelSeparator << std::endl << "        { \"kernel\": \"" << kernelName(static_cast<Kernel>(k)) << "\", \"bytes\": " << kernel.bytes
+                      << ", \"calls\": " << kernel.calls << ", \"nanoseconds\": " << kernel.nanoseconds << ", \"sizes\": [";
+
+                    for (size_t b = 0; b < CRCMetrics::numSizeBuckets; ++b)
+                    {
+                        s << (b == 0 ? "" : ", ") << kernel.sizes[b];
+                    }
+
+                    s << "], \"latencies\": [";
+
+                    for (size_t b = 0; b < CRCMetrics::numLatencyBuckets; ++b)
+                    {
+                        s << (b == 0 ? "" : ", ") << kernel.latencies[b];
+                    }
+
+                    s << "] }";
+                    kernelSeparator = ",";
+                }
+
+                s << std::endl << "      ]" << std::endl << "    }";
+                separator = ",";
+            }
+
+            s << std::endl << "  ]" << std::endl << "}" << std::endl;
+        }
+
+    private:
+        typedef CRCMetrics::Snapshot::value_type Entry;
+
+        /// @return the generator polynomial in hex, with as many digits as the width needs
+        static std::string generator(CRCMetrics::Algorithm const& a)
+        {
+            std::ostringstream s;
+            s << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw((a.bits + 3) / 4) << a.generator;
+            return s.str();
+        }
+
+        /// @return the name of an algorithm, or its width, bit order and generator polynomial
+        static std::string name(Entry const& entry)
+        {
+            if (!entry.second.name.empty())
+            {
+                return entry.second.name;
+            }
+
+            std::ostringstream s;
+            s << entry.first.bits << (entry.first.reflected ? "N " : " ") << generator(entry.first).substr(2);
+            return s.str();
+        }
+
+        /// @return the labels of an algorithm and a kernel (none if kernel < 0), without the closing brace
+        static std::string labels(Entry const& entry, int kernel)
+        {
+            std::string labels = "{algorithm=\"" + escape(name(entry)) + "\"";
+
+            if (kernel >= 0)
+            {
+                labels += ",kernel=\"" + std::string(kernelName(static_cast<Kernel>(kernel))) + "\"";
+            }
+
+            return labels;
+        }
+
+        /// @return the string with backslashes, quotes and newlines escaped, for Prometheus labels and JSON strings
+        static std::string escape(std::string const& text)
+        {
+            std::string escaped;
+
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] == '\\' || text[i] == '"')
+                {
+                    escaped += '\\';
+                    escaped += text[i];
+                }
+                else if (text[i] == '\n')
+                {
+                    escaped += "\\n";
+                }
+                else
+                {
+                    escaped += text[i];
+                }
+            }
+
+            return escaped;
+        }
+    };
+}
@@ -0,0 +1,979 @@
+#pragma once
+/*
+ * crcpoly.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcpoly.h
+ * @brief Contains arithmetic on polynomials over GF(2), to examine generator polynomials
+ */
+
+#include "crc.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief A polynomial over GF(2) of any degree
+     *
+     * Poly and PolyN hold the remainders modulo a generator, without its leading term, in the bit order
+     * of the CRC. GF2Poly holds a whole polynomial: bit i of word i / 64 is the coefficient of X^(i % 64),
+     * whatever the bit order of the CRC it came from. It provides the operations needed to examine a generator:
+     * products (with PCLMULQDQ where the CPU has it), division, powers modulo a polynomial, the greatest
+     * common divisor, the test for irreducibility by Rabin, the factorisation by Berlekamp, and the test
+     * whether a polynomial is primitive, i.e. X generates all 2^n - 1 non-zero remainders.
+     *
+     * The operations are meant for polynomials of the size of CRC generators. Polynomials of degree 64 are
+     * factored in well below a millisecond.
+     */
+    class GF2Poly
+    {
+    public:
+        struct Factor;
+
+        /**
+         * Constructor.
+         * @param coefficients bit i is the coefficient of X^i
+         */
+        GF2Poly(uint64_t coefficients = 0)
+        {
+            if (coefficients != 0)
+            {
+                _words.push_back(coefficients);
+            }
+        }
+
+        /**
+         * @param n the degree
+         * @return the polynomial X^n
+         */
+        static GF2Poly monomial(unsigned int n)
+        {
+            GF2Poly result;
+            result._words.resize(n / 64 + 1, 0);
+            result._words.back() = static_cast<uint64_t>(1) << (n % 64);
+            return result;
+        }
+
+        /**
+         * The generator polynomial of a CRC, including its leading term X^numbits.
+         * @param generator the generator in the bit order of the CRC, as passed to CRC::CRC()
+         * @return the generator polynomial
+         */
+        template <class P> static GF2Poly generator(P const& generator)
+        {
+            GF2Poly result = monomial(P::numbits);
+            uint64_t value = static_cast<typename P::data_type>(generator);
+
+            for (unsigned int i = 0; i < P::numbits; ++i)
+            {
+                unsigned int bit = P::reflected ? P::numbits - 1 - i : i;
+
+                if ((value >> bit) & 1)
+                {
+                    result._words[0] |= static_cast<uint64_t>(1) << i;
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * The generator of a CRC in its bit order, without the leading term: the inverse of generator().
+         * @return the generator as passed to CRC::CRC()
+         * @throw std::logic_error if the degree of the polynomial is not the number of bits of the CRC
+         */
+        template <class P> P toGenerator() const
+        {
+            if (degree() != static_cast<int>(P::numbits))
+            {
+                throw std::logic_error("The degree of the polynomial does not match the CRC");
+            }
+
+            uint64_t value = 0;
+
+            for (unsigned int i = 0; i < P::numbits; ++i)
+            {
+                if (coefficient(i))
+                {
+                    value |= static_cast<uint64_t>(1) << (P::reflected ? P::numbits - 1 - i : i);
+                }
+            }
+
+            return static_cast<typename P::data_type>(value);
+        }
+
+        /// @return the degree of the polynomial, -1 for the zero polynomial
+        int degree() const
+        {
+            if (_words.empty())
+            {
+                return -1;
+            }
+
+            uint64_t top = _words.back();
+            int bit = 63;
+
+            while ((top >> bit) == 0)
+            {
+                --bit;
+            }
+
+            return static_cast<int>(64 * (_words.size() - 1)) + bit;
+        }
+
+        /**
+         * @param i the exponent
+         * @return the coefficient of X^i
+         */
+        bool coefficient(unsigned int i) const
+        {
+            return i / 64 < _words.size() && ((_words[i / 64] >> (i % 64)) & 1) != 0;
+        }
+
+        /// @return whether this is the zero polynomial
+        bool isZero() const
+        {
+            return _words.empty();
+        }
+
+        /// @return the number of non-zero coefficients
+        unsigned int weight() const
+        {
+            unsigned int result = 0;
+
+            for (size_t i = 0; i < _words.size(); ++i)
+            {
+                for (uint64_t word = _words[i]; word != 0; word &= word - 1)
+                {
+                    ++result;
+                }
+            }
+
+            return result;
+        }
+
+        bool operator == (GF2Poly const& other) const
+        {
+            return _words == other._words;
+        }
+
+        bool operator != (GF2Poly const& other) const
+        {
+            return _words != other._words;
+        }
+
+        /// Order by degree, then by the coefficients from the highest one down
+        bool operator < (GF2Poly const& other) const
+        {
+            if (_words.size() != other._words.size())
+            {
+                return _words.size() < other._words.size();
+            }
+
+            return std::lexicographical_compare(_words.rbegin(), _words.rend(), other._words.rbegin(), other._words.rend());
+        }
+
+        /// Sum, which is the same as the difference
+        GF2Poly& operator += (GF2Poly const& other)
+        {
+            if (_words.size() < other._words.size())
+            {
+                _words.resize(other._words.size(), 0);
+            }
+
+            for (size_t i = 0; i < other._words.size(); ++i)
+            {
+                _words[i] ^= other._words[i];
+            }
+
+            trim();
+            return *this;
+        }
+
+        GF2Poly operator + (GF2Poly const& other) const
+        {
+            GF2Poly result = *this;
+            result += other;
+            return result;
+        }
+
+        /// Product: carry-less multiplication of the words
+        GF2Poly operator * (GF2Poly const& other) const
+        {
+            GF2Poly result;
+
+            if (isZero() || other.isZero())
+            {
+                return result;
+            }
+
+            result._words.resize(_words.size() + other._words.size(), 0);
+
+            for (size_t i = 0; i < _words.size(); ++i)
+            {
+                for (size_t j = 0; j < other._words.size(); ++j)
+                {
+                    uint64_t lo, hi;
+                    clmul(_words[i], other._words[j], lo, hi);
+                    result._words[i + j] ^= lo;
+                    result._words[i + j + 1] ^= hi;
+                }
+            }
+
+            result.trim();
+            return result;
+        }
+
+        GF2Poly& operator *= (GF2Poly const& other)
+        {
+            return *this = *this * other;
+        }
+
+        /**
+         * Divide with remainder: dividend = quotient * divisor + remainder, with deg remainder < deg divisor
+         * @param dividend  the dividend
+         * @param divisor   the divisor
+         * @param quotient  receives the quotient
+         * @param remainder receives the remainder
+         * @throw std::logic_error if the divisor is zero
+         */
+        static void divide(GF2Poly const& dividend, GF2Poly const& divisor, GF2Poly& quotient, GF2Poly& remainder)
+        {
+            int n = divisor.degree();
+
+            if (n < 0)
+            {
+                throw std::logic_error("Division by the zero polynomial");
+            }
+
+            GF2Poly work = dividend;
+            GF2Poly result;
+            int d = work.degree();
+
+            if (d >= n)
+            {
+                result._words.resize((d - n) / 64 + 1, 0);
+            }
+
+            for (; d >= n; d = work.degree())
+            {
+                unsigned int shift = static_cast<unsigned int>(d - n);
+                result._words[shift / 64] |= static_cast<uint64_t>(1) << (shift % 64);
+                work.addShifted(divisor, shift);
+            }
+
+            result.trim();
+            quotient = result;
+            remainder = work;
+        }
+
+        GF2Poly operator / (GF2Poly const& divisor) const
+        {
+            GF2Poly quotient, remainder;
+            divide(*this, divisor, quotient, remainder);
+            return quotient;
+        }
+
+        GF2Poly operator % (GF2Poly const& divisor) const
+        {
+            GF2Poly quotient, remainder;
+            divide(*this, divisor, quotient, remainder);
+            return remainder;
+        }
+
+        /**
+         * @param exponent the exponent
+         * @param modulus  the modulus, not zero
+         * @return this ^ exponent mod modulus
+         */
+        GF2Poly powMod(uint64_t exponent, GF2Poly const& modulus) const
+        {
+            GF2Poly result = GF2Poly(1) % modulus;
+            GF2Poly base = *this % modulus;
+
+            for (; exponent != 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    result = (result * base) % modulus;
+                }
+
+                if (exponent > 1)
+                {
+                    base = (base * base) % modulus;
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * @param exponent the exponent
+         * @return this ^ exponent
+         */
+        GF2Poly pow(unsigned int exponent) const
+        {
+            GF2Poly result = 1;
+            GF2Poly base = *this;
+
+            for (; exponent != 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    result *= base;
+                }
+
+                if (exponent > 1)
+                {
+                    base *= base;
+                }
+            }
+
+            return result;
+        }
+
+        /// @return the greatest common divisor of a and b
+        static GF2Poly gcd(GF2Poly a, GF2Poly b)
+        {
+            while (!b.isZero())
+            {
+                GF2Poly r = a % b;
+                a = b;
+                b = r;
+            }
+
+            return a;
+        }
+
+        /// @return the formal derivative: the odd powers, lowered by one
+        GF2Poly derivative() const
+        {
+            GF2Poly result = *this;
+
+            for (size_t i = 0; i < result._words.size(); ++i)
+            {
+                result._words[i] = (result._words[i] >> 1) & 0x5555555555555555ULL;
+            }
+
+            result.trim();
+            return result;
+        }
+
+        /**
+         * Rabin's test: f of degree n is irreducible if and only if X^(2^n) = X mod f,
+         * and gcd(X^(2^(n/q)) - X, f) = 1 for each prime q dividing n.
+         * @return whether the polynomial is irreducible
+         */
+        bool isIrreducible() const
+        {
+            int n = degree();
+
+            if (n <= 1)
+            {
+                return n == 1;
+            }
+
+            GF2Poly const x = 2;
+            std::vector<uint64_t> primes = primeFactors(static_cast<uint64_t>(n));
+
+            for (size_t i = 0; i < primes.size(); ++i)
+            {
+                if (gcd(frobenius(static_cast<unsigned int>(n / primes[i])) + x, *this) != GF2Poly(1))
+                {
+                    return false;
+                }
+            }
+
+            return frobenius(static_cast<unsigned int>(n)) == x;
+        }
+
+        /**
+         * A polynomial f of degree n is primitive if it is irreducible and X has the order 2^n - 1 modulo f,
+         * i.e. X^((2^n - 1) / p) != 1 mod f for each prime p dividing 2^n - 1.
+         * A CRC with a primitive generator detects all double bit errors in codewords of up to 2^n - 1 bits.
+         * @return whether the polynomial is primitive
+         * @throw std::logic_error if the degree is more than 64
+         */
+        bool isPrimitive() const
+        {
+            int n = degree();
+
+            if (n > 64)
+            {
+                throw std::logic_error("Primitivity can only be tested up to degree 64");
+            }
+
+            if (!coefficient(0) || !isIrreducible())
+            {
+                return false;
+            }
+
+            uint64_t order = ~static_cast<uint64_t>(0) >> (64 - n);
+            std::vector<uint64_t> primes = primeFactors(order);
+            GF2Poly const x = 2;
+
+            for (size_t i = 0; i < primes.size(); ++i)
+            {
+                if (x.powMod(order / primes[i], *this) == GF2Poly(1))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+
+        /**
+         * Factor the polynomial into irreducible polynomials: first into square free parts,
+         * using the derivative, then each part by Berlekamp's algorithm.
+         * @return the irreducible factors with their multiplicities, ordered by degree. Empty for 1.
+         * @throw std::logic_error for the zero polynomial
+         */
+        std::vector<Factor> factor() const;
+
+        /**
+         * Write a factorisation, e.g. (X + 1)^2 (X^2 + X + 1)
+         * @param s       the stream to write to
+         * @param factors the factors, as returned by factor()
+         */
+        static void write(std::ostream& s, std::vector<Factor> const& factors);
+
+        /**
+         * Write the polynomial in the format of the CRC tool, e.g. X^16 + X^12 + X^5 + 1
+         * @param s the stream to write to
+         */
+        void write(std::ostream& s) const
+        {
+            if (isZero())
+            {
+                s << "0";
+                return;
+            }
+
+            char const* separator = "";
+
+            for (int i = degree(); i >= 0; --i)
+            {
+                if (coefficient(static_cast<unsigned int>(i)))
+                {
+                    s << separator;
+                    separator = " + ";
+
+                    if (i == 0)
+                    {
+                        s << "1";
+                    }
+                    else if (i == 1)
+                    {
+                        s << "X";
+                    }
+                    else
+                    {
+                        s << "X^" << i;
+                    }
+                }
+            }
+        }
+
+
+    private:
+        /// Remove leading zero words
+        void trim()
+        {
+            while (!_words.empty() && _words.back() == 0)
+            {
+                _words.pop_back();
+            }
+        }
+
+        /// Add other * X^shift
+        void addShifted(GF2Poly const& other, unsigned int shift)
+        {
+            size_t words = shift / 64;
+            unsigned int bits = shift % 64;
+            size_t size = other._words.size() + words + (bits != 0 ? 1 : 0);
+
+            if (_words.size() < size)
+            {
+                _words.resize(size, 0);
+            }
+
+            for (size_t i = 0; i < other._words.size(); ++i)
+            {
+                _words[i + words] ^= other._words[i] << bits;
+
+                if (bits != 0)
+                {
+                    _words[i + words + 1] ^= other._words[i] >> (64 - bits);
+                }
+            }
+
+            trim();
+        }
+
+        /// @return X^(2^k) mod this, by squaring k times
+        GF2Poly frobenius(unsigned int k) const
+        {
+            GF2Poly result = GF2Poly(2) % *this;
+
+            for (unsigned int i = 0; i < k; ++i)
+            {
+                result = (result * result) % *this;
+            }
+
+            return result;
+        }
+
+        /// @return the square root of a polynomial with even powers only
+        GF2Poly squareRoot() const
+        {
+            GF2Poly result;
+            int n = degree();
+            result._words.resize(n / 128 + 1, 0);
+
+            for (int i = 0; i <= n; i += 2)
+            {
+                if (coefficient(static_cast<unsigned int>(i)))
+                {
+                    result._words[i / 128] |= static_cast<uint64_t>(1) << ((i / 2) % 64);
+                }
+            }
+
+            result.trim();
+            return result;
+        }
+
+
+
+        /// Split f into square free parts, and those into irreducible factors, each of them multiplicity times
+        static void squareFree(GF2Poly f, unsigned int multiplicity, std::vector<Factor>& result);
+
+        /**
+         * Berlekamp's algorithm for a square free f of degree n: the polynomials v with v^2 = v mod f form
+         * a vector space whose dimension is the number of irreducible factors. They are the null space of
+         * Q - I, with row i of Q being X^(2i) mod f. gcd(f, v) and gcd(f, v + 1) split f for any such v but 0 and 1.
+         */
+        static void berlekamp(GF2Poly const& f, unsigned int multiplicity, std::vector<Factor>& result);
+
+        /// Carry-less product of two words
+        static void clmul(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi)
+        {
+#if defined (CRCPP_HAVE_X86_KERNELS)
+            static bool const pclmul = CPUFeatures::get().pclmul;
+
+            if (pclmul)
+            {
+                clmulPCLMUL(a, b, lo, hi);
+                return;
+            }
+#endif
+            lo = 0;
+            hi = 0;
+
+            for (unsigned int i = 0; i < 64; ++i)
+            {
+                if ((b >> i) & 1)
+                {
+                    lo ^= a << i;
+                    hi ^= i != 0 ? a >> (64 - i) : 0;
+                }
+            }
+        }
+
+#if defined (CRCPP_HAVE_X86_KERNELS)
+        CRCPP_TARGET("pclmul")
+        static void clmulPCLMUL(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi)
+        {
+            __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(a)),
+                                                   _mm_cvtsi64_si128(static_cast<int64_t>(b)), 0x00);
+            lo = static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+            hi = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product)));
+        }
+#endif
+
+        /// a * b mod m for integers
+        static uint64_t mulMod64(uint64_t a, uint64_t b, uint64_t m)
+        {
+#if defined (__SIZEOF_INT128__)
+            // __extension__ keeps -Wpedantic quiet about the GNU 128 bit type
+            __extension__ typedef unsigned __int128 uint128;
+            return static_cast<uint64_t>(static_cast<uint128>(a) * b % m);
+#else
+            uint64_t result = 0;
+            a %= m;
+
+            for (; b != 0; b >>= 1)
+            {
+                if (b & 1)
+                {
+                    result = result >= m - a ? result - (m - a) : result + a;
+                }
+
+                a = a >= m - a ? a - (m - a) : a + a;
+            }
+
+            return result;
+#endif
+        }
+
+        /// a ^ e mod m for integers
+        static uint64_t powMod64(uint64_t a, uint64_t e, uint64_t m)
+        {
+            uint64_t result = 1 % m;
+
+            for (a %= m; e != 0; e >>= 1)
+            {
+                if (e & 1)
+                {
+                    result = mulMod64(result, a, m);
+                }
+
+                a = mulMod64(a, a, m);
+            }
+
+            return result;
+        }
+
+        /// Miller-Rabin with the bases which decide all 64 bit integers
+        static bool isPrime(uint64_t n)
+        {
+            static uint64_t const bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+            if (n < 2)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); ++i)
+            {
+                if (n % bases[i] == 0)
+                {
+                    return n == bases[i];
+                }
+            }
+
+            uint64_t d = n - 1;
+            unsigned int s = 0;
+
+            while ((d & 1) == 0)
+            {
+                d >>= 1;
+                ++s;
+            }
+
+            for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); ++i)
+            {
+                uint64_t x = powMod64(bases[i], d, n);
+                bool witness = x != 1 && x != n - 1;
+
+                for (unsigned int r = 1; r < s && witness; ++r)
+                {
+                    x = mulMod64(x, x, n);
+                    witness = x != n - 1;
+                }
+
+                if (witness)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// A non-trivial divisor of the odd composite n, by Pollard's rho method
+        static uint64_t findDivisor(uint64_t n)
+        {
+            for (uint64_t c = 1; ; ++c)
+            {
+                uint64_t x = 2, y = 2, d = 1;
+
+                while (d == 1)
+                {
+                    x = (mulMod64(x, x, n) + c) % n;
+                    y = (mulMod64(y, y, n) + c) % n;
+                    y = (mulMod64(y, y, n) + c) % n;
+                    d = gcd64(x > y ? x - y : y - x, n);
+                }
+
+                if (d != n)
+                {
+                    return d;
+                }
+            }
+        }
+
+        static uint64_t gcd64(uint64_t a, uint64_t b)
+        {
+            while (b != 0)
+            {
+                uint64_t r = a % b;
+                a = b;
+                b = r;
+            }
+
+            return a;
+        }
+
+        /// @return the distinct prime factors of n, in ascending order
+        static std::vector<uint64_t> primeFactors(uint64_t n)
+        {
+            std::vector<uint64_t> result;
+            std::vector<uint64_t> pending;
+
+            for (uint64_t p = 2; p < 1000 && p * p <= n; p += (p == 2 ? 1 : 2))
+            {
+                if (n % p == 0)
+                {
+                    result.push_back(p);
+
+                    while (n % p == 0)
+                    {
+                        n /= p;
+                    }
+                }
+            }
+
+            if (n > 1)
+            {
+                pending.push_back(n);
+            }
+
+            while (!pending.empty())
+            {
+                uint64_t m = pending.back();
+                pending.pop_back();
+
+                if (isPrime(m))
+                {
+                    result.push_back(m);
+                }
+                else
+                {
+                    uint64_t d = findDivisor(m);
+                    pending.push_back(d);
+                    pending.push_back(m / d);
+                }
+            }
+
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+            return result;
+        }
+
+        std::vector<uint64_t> _words;    ///< the coefficients, 64 per word, without leading zero words
+    };
+
+    /**
+     * An irreducible factor and how often it divides the polynomial
+     */
+    struct GF2Poly::Factor
+    {
+        GF2Poly poly;
+        unsigned int multiplicity;
+    };
+
+    inline std::vector<GF2Poly::Factor> GF2Poly::factor() const
+    {
+        if (isZero())
+        {
+            throw std::logic_error("The zero polynomial cannot be factored");
+        }
+
+        std::vector<Factor> result;
+        squareFree(*this, 1, result);
+        std::sort(result.begin(), result.end(), [](Factor const& a, Factor const& b) { return a.poly < b.poly; });
+        return result;
+    }
+
+    inline void GF2Poly::write(std::ostream& s, std::vector<Factor> const& factors)
+    {
+        for (size_t i = 0; i < factors.size(); ++i)
+        {
+            s << (i == 0 ? "(" : " (");
+            factors[i].poly.write(s);
+            s << ")";
+
+            if (factors[i].multiplicity > 1)
+            {
+                s << "^" << factors[i].multiplicity;
+            }
+        }
+    }
+
+    inline void GF2Poly::squareFree(GF2Poly f, unsigned int multiplicity, std::vector<Factor>& result)
+    {
+        GF2Poly const one = 1;
+        GF2Poly d = f.derivative();
+
+        if (d.isZero())
+        {
+            // f is a square
+            if (f != one)
+            {
+                squareFree(f.squareRoot(), 2 * multiplicity, result);
+            }
+
+            return;
+        }
+
+        // w is the product of the factors, c what is left when they are removed once
+        GF2Poly c = gcd(f, d);
+        GF2Poly w = f / c;
+
+        for (unsigned int i = 1; w != one; ++i)
+        {
+            GF2Poly y = gcd(w, c);
+            GF2Poly part = w / y;
+
+            if (part != one)
+            {
+                berlekamp(part, i * multiplicity, result);
+            }
+
+            w = y;
+            c = c / y;
+        }
+
+        // The factors of c which are left occur a multiple of 2 times
+        if (c != one)
+        {
+            squareFree(c.squareRoot(), 2 * multiplicity, result);
+        }
+    }
+
+    inline void GF2Poly::berlekamp(GF2Poly const& f, unsigned int multiplicity, std::vector<Factor>& result)
+    {
+        unsigned int n = static_cast<unsigned int>(f.degree());
+
+        // Column j of Q - I, as a polynomial: coefficient i is entry (i, j)
+        std::vector<GF2Poly> columns(n);
+        GF2Poly row = 1;
+        GF2Poly const x2 = 4;
+
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            GF2Poly entries = row + monomial(i);
+
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                if (entries.coefficient(j))
+                {
+                    columns[j].addShifted(1, i);
+                }
+            }
+
+            row = (row * x2) % f;
+        }
+
+        // Reduced row echelon form of (Q - I)^T: v (Q - I) = 0 becomes (Q - I)^T v = 0
+        std::vector<unsigned int> pivots;
+
+        for (unsigned int col = 0; col < n && pivots.size() < n; ++col)
+        {
+            size_t rank = pivots.size();
+            size_t r = rank;
+
+            while (r < n && !columns[r].coefficient(col))
+            {
+                ++r;
+            }
+
+            if (r == n)
+            {
+                continue;
+            }
+
+            std::swap(columns[r], columns[rank]);
+
+            for (size_t other = 0; other < n; ++other)
+            {
+                if (other != rank && columns[other].coefficient(col))
+                {
+                    columns[other] += columns[rank];
+                }
+            }
+
+            pivots.push_back(col);
+        }
+
+        // A basis of the null space: one vector for each column without a pivot
+        std::vector<GF2Poly> basis;
+
+        for (unsigned int col = 0, p = 0; col < n; ++col)
+        {
+            if (p < pivots.size() && pivots[p] == col)
+            {
+                ++p;
+                continue;
+            }
+
+            GF2Poly v = monomial(col);
+
+            for (size_t r = 0; r < pivots.size(); ++r)
+            {
+                if (columns[r].coefficient(col))
+                {
+                    v.addShifted(1, pivots[r]);
+                }
+            }
+
+            basis.push_back(v);
+        }
+
+        // Split with each basis vector until there are as many factors as the dimension
+        std::vector<GF2Poly> factors(1, f);
+
+        for (size_t b = 0; b < basis.size() && factors.size() < basis.size(); ++b)
+        {
+            for (size_t i = 0, count = factors.size(); i < count && factors.size() < basis.size(); ++i)
+            {
+                GF2Poly g = gcd(factors[i], basis[b]);
+
+                if (g.degree() > 0 && g != factors[i])
+                {
+                    factors.push_back(factors[i] / g);
+                    factors[i] = g;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < factors.size(); ++i)
+        {
+            Factor factor = { factors[i], multiplicity };
+            result.push_back(factor);
+        }
+    }
+
+    /// Write a polynomial to a stream
+    inline std::ostream& operator << (std::ostream& s, GF2Poly const& poly)
+    {
+        poly.write(s);
+        return s;
+    }
+}
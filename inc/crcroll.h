@@ -0,0 +1,258 @@
+#pragma once
+/*
+ * crcroll.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcroll.h
+ * @brief Contains the rolling (sliding window) CRC and a content defined chunker built on it
+ */
+
+#include "crc.h"
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief CRC over a sliding window of a fixed number of bytes
+     *
+     * The rolling CRC is the CRC of the last @c window bytes fed into it, computed with a zero
+     * register as starting value (no preset, no inversion). It is the value CRC<P>::add() would
+     * leave in a zero initialised register after adding just the bytes in the window.
+     *
+     * Since the CRC is linear, the contribution of the byte leaving the window does not depend
+     * on the other bytes. It is the table entry of that byte multiplied by X^(8*window) mod G,
+     * so removing it is a single lookup into a second table which is computed once, in the constructor.
+     * Until the window has been filled completely, the value is the CRC of the bytes added so far.
+     */
+    template <class P> class CRCRolling
+    {
+    public:
+        /**
+         * Constructor.
+         * @param algorithm   The CRC algorithm to use
+         * @param window      The window size in bytes. Must not be 0.
+         */
+        CRCRolling(CRC<P> const& algorithm, size_t window) :
+            _algorithm(algorithm),
+            _window(window, 0),
+            _pos(0),
+            _crc(0)
+        {
+            if (window == 0)
+            {
+                throw std::logic_error("Window size of a rolling CRC must not be 0");
+            }
+
+            // Contribution of a single bit leaving the window: the bit, followed by window zero bytes
+            P bits[8];
+
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                P reg = 0;
+                _algorithm.add(static_cast<uint8_t>(1 << bit), reg);
+                _algorithm.addZeros(window, reg);
+                bits[bit] = reg;
+            }
+
+            // Every other byte is a sum of bits
+            _out[0] = 0;
+
+            for (unsigned int index = 1; index < 256; ++index)
+            {
+                unsigned int lowest = index & (0U - index);
+                int bit = 0;
+
+                while ((lowest >> bit) != 1)
+                {
+                    ++bit;
+                }
+
+                _out[index] = _out[index ^ lowest] ^ bits[bit];
+            }
+        }
+
+        /**
+         * Shift a byte into the window. The oldest byte is removed from the window.
+         * @param data the byte to add
+         * @return the CRC of the window after the update
+         */
+        P add(uint8_t data)
+        {
+            _crc = roll(data, _window[_pos], _crc);
+            _window[_pos] = data;
+
+            if (++_pos == _window.size())
+            {
+                _pos = 0;
+            }
+
+            return _crc;
+        }
+
+        /**
+         * Shift bytes into the window.
+         * @param data the data to add
+         * @param len  the number of bytes to add
+         * @return the CRC of the window after the update
+         */
+        P add(uint8_t const* data, size_t len)
+        {
+            while (len > 0)
+            {
+                add(*data++);
+                --len;
+            }
+
+            return _crc;
+        }
+
+        /**
+         * The core update step, for callers who keep the window contents themselves.
+         * @param in   the byte entering the window
+         * @param out  the byte leaving the window (0 while the window is not yet filled)
+         * @param reg  the rolling CRC before the update
+         * @return the rolling CRC after the update
+         */
+        P roll(uint8_t in, uint8_t out, P reg) const
+        {
+            _algorithm.add(in, reg);
+            return reg ^ _out[out];
+        }
+
+        /// @return the CRC of the current window contents
+        P crc() const
+        {
+            return _crc;
+        }
+
+        /// @return the window size in bytes
+        size_t window() const
+        {
+            return _window.size();
+        }
+
+        /// Empty the window
+        void reset()
+        {
+            std::fill(_window.begin(), _window.end(), 0);
+            _pos = 0;
+            _crc = 0;
+        }
+
+    private:
+        CRC<P>                  _algorithm;
+        P                       _out[256];
+        std::vector<uint8_t>    _window;
+        size_t                  _pos;
+        P                       _crc;
+    };
+
+    /**
+     * @ingroup CRCpp
+     * @brief Content defined chunking using a rolling CRC
+     *
+     * A chunk ends after a byte if the rolling CRC of the window ending with that byte,
+     * masked with @c mask, equals @c mask, and the chunk has at least @c minSize bytes.
+     * Independent of content, a chunk ends when it reaches @c maxSize bytes. Since the boundaries
+     * only depend on the data, they are the same no matter how the data is split into buffers.
+     *
+     * The condition compares against the mask rather than against 0, so that runs of zero bytes
+     * (with a rolling CRC of 0) do not produce a boundary at every position.
+     * With n bits set in the mask, the average chunk size is about 2^n bytes plus @c minSize.
+     */
+    template <class P> class CRCChunker
+    {
+    public:
+        typedef typename P::data_type data_type;
+
+        /**
+         * Constructor.
+         * @param algorithm   The CRC algorithm to use
+         * @param window      The window size of the rolling CRC in bytes
+         * @param mask        The bits of the rolling CRC which are used to find a boundary
+         * @param minSize     The minimum size of a chunk
+         * @param maxSize     The maximum size of a chunk, 0 for unlimited
+         */
+        CRCChunker(CRC<P> const& algorithm, size_t window, data_type mask,
+                   size_t minSize = 0, size_t maxSize = 0) :
+            _rolling(algorithm, window),
+            _mask(mask),
+            _minSize(minSize),
+            _maxSize(maxSize),
+            _size(0)
+        {
+            if (maxSize != 0 && maxSize < minSize)
+            {
+                throw std::logic_error("Maximum chunk size must not be smaller than minimum chunk size");
+            }
+        }
+
+        /**
+         * Scan data for the end of the current chunk.
+         * @param data the data to scan
+         * @param len  the number of bytes in data
+         * @return the number of bytes of data up to and including the last byte of the current chunk,
+         *         or 0 if the current chunk does not end within data. In that case all of data belongs
+         *         to the current chunk, and scanning continues with the next call.
+         */
+        size_t next(uint8_t const* data, size_t len)
+        {
+            for (size_t i = 0; i < len; ++i)
+            {
+                data_type crc = _rolling.add(data[i]);
+                ++_size;
+
+                if ((_size >= _minSize && (crc & _mask) == _mask) || _size == _maxSize)
+                {
+                    _size = 0;
+                    return i + 1;
+                }
+            }
+
+            return 0;
+        }
+
+        /// @return the number of bytes scanned so far in the current chunk
+        size_t size() const
+        {
+            return _size;
+        }
+
+        /// Start over, as if no data had been scanned
+        void reset()
+        {
+            _rolling.reset();
+            _size = 0;
+        }
+
+    private:
+        CRCRolling<P>   _rolling;
+        data_type       _mask;
+        size_t          _minSize;
+        size_t          _maxSize;
+        size_t          _size;
+    };
+}
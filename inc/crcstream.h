@@ -133,6 +133,7 @@ namespace CrcPP
         CRCStream<P>& operator << (char const data)
         {
             _algorithm.add(data, _crc);
+            _bits += 8;
             return *this;
         }
 
@@ -143,6 +144,7 @@ namespace CrcPP
         CRCStream<P>& operator << (uint8_t const data)
         {
             _algorithm.add(data, _crc);
+            _bits += 8;
             return *this;
         }
 
@@ -152,12 +154,7 @@ namespace CrcPP
          */
         CRCStream<P>& operator << (char const* data)
         {
-            while (*data)
-            {
-                _algorithm.add(*data++, _crc);
-            }
-
-            return *this;
+            return add(reinterpret_cast<uint8_t const*>(data), std::strlen(data));
         }
 
         /**
@@ -166,28 +163,11 @@ namespace CrcPP
          *
          * The main requirement for the collection given in the data parameter is that it
          * has an iterator and that the collection contents are of a data type supported
-         * by the CRC class.
+         * by the CRC class. Strings and vectors of bytes are added in one go by the bulk kernel.
          */
         template <class D> CRCStream<P>& operator << (D const& data)
         {
-#ifdef  	__cpp_range_based_for
-
-            for (auto const& byte : data)
-            {
-                _algorithm.add(byte, _crc);
-            }
-
-#else
-            typename D::const_iterator it;
-
-            for (it = data.begin(); it != data.end(); ++it)
-            {
-                _algorithm.add(*it, _crc);
-            }
-
-#endif
-
-            return *this;
+            return insert(data, isContiguousBytes<D>());
         }
 
         /**
@@ -199,6 +179,7 @@ namespace CrcPP
         CRCStream<P>& operator << (P const& data)
         {
             _algorithm.add(data, _crc);
+            _bits += P::numbits;
             return *this;
         }
 
@@ -209,6 +190,69 @@ namespace CrcPP
         CRCStream<P>& addBit(uint8_t bit)
         {
             _algorithm.addbit(bit, _crc);
+            _bits += 1;
+            return *this;
+        }
+
+        /**
+         *	Add a sequence of bytes
+         *	@param data The bytes to add
+         *	@param len The number of bytes to add
+         */
+        CRCStream<P>& add(uint8_t const* data, size_t len)
+        {
+            _algorithm.add(data, len, _crc);
+            _bits += 8 * static_cast<uint64_t>(len);
+            return *this;
+        }
+
+        /**
+         *	Copy a sequence of bytes and add it in the same pass
+         *	@param dst The destination
+         *	@param src The bytes to copy and add
+         *	@param len The number of bytes
+         *	@see CRC::copyAndAdd()
+         */
+        CRCStream<P>& copyAndAdd(uint8_t* dst, uint8_t const* src, size_t len)
+        {
+            _algorithm.copyAndAdd(dst, src, len, _crc);
+            _bits += 8 * static_cast<uint64_t>(len);
+            return *this;
+        }
+
+        /**
+         *	Add a sequence of zero bytes in O(log n)
+         *	@param n The number of zero bytes to add
+         */
+        CRCStream<P>& addZeros(size_t n)
+        {
+            _algorithm.addZeros(n, _crc);
+            _bits += 8 * static_cast<uint64_t>(n);
+            return *this;
+        }
+
+        /**
+         *	Add data which is only known by its CRC register, in O(log n)
+         *	@param crc The register value after adding the data to a zero register
+         *	@param len The number of bytes of the data
+         *	@see CRC::combine()
+         */
+        CRCStream<P>& combine(P const& crc, size_t len)
+        {
+            _crc = _algorithm.combine(_crc, crc, len);
+            _bits += 8 * static_cast<uint64_t>(len);
+            return *this;
+        }
+
+        /**
+         *	Add a sequence of identical bytes in O(log n)
+         *	@param data The value of the bytes
+         *	@param n The number of bytes to add
+         */
+        CRCStream<P>& addFill(uint8_t data, size_t n)
+        {
+            _algorithm.addFill(data, n, _crc);
+            _bits += 8 * static_cast<uint64_t>(n);
             return *this;
         }
 
@@ -241,7 +285,21 @@ namespace CrcPP
         {
             P goodcrc = 0;
             _algorithm.add(_invert, goodcrc);
-            return _crc == goodcrc;
+            return counted(_crc == goodcrc);
+        }
+
+        /**
+         * Returns the syndrome of the data checked: the difference between the CRC register
+         * and the value it has for a good CRC.
+         * The syndrome is 0 if the CRC is good. Otherwise, it only depends on the error pattern
+         * and the length of the data, not on the data itself.
+         * @return the syndrome
+         */
+        P syndrome() const
+        {
+            P goodcrc = 0;
+            _algorithm.add(_invert, goodcrc);
+            return _crc ^ goodcrc;
         }
 
         /**
@@ -263,13 +321,79 @@ namespace CrcPP
                 _algorithm.addbit(0, goodcrc);
             }
 
-            return _crc == goodcrc;
+            return counted(_crc == goodcrc);
         }
 
         /// Reset the stream for reuse in another calculation
         void reset()
         {
             _crc = _preset;
+            _bits = 0;
+        }
+
+        /// @return the number of bytes added since the last reset
+        uint64_t length() const
+        {
+            return _bits / 8;
+        }
+
+        /// @return the number of bits added since the last reset
+        uint64_t bits() const
+        {
+            return _bits;
+        }
+
+        /**
+         * Export the state of the calculation, so it can be continued later, for example by another process.
+         * The state holds the register, the number of bits added, and the identity of the algorithm:
+         * width, bit order, generator, preset and invert. It has stateSize bytes, in little endian byte order.
+         * @return the state
+         */
+        std::vector<uint8_t> exportState() const
+        {
+            std::vector<uint8_t> state(stateSize, 0);
+            std::memcpy(&state[0], stateMagic(), 4);
+            state[4] = stateVersion;
+            state[5] = static_cast<uint8_t>(P::numbits);
+            state[6] = P::reflected ? 1 : 0;
+            putState(&state[8], _algorithm.generator());
+            putState(&state[16], _preset);
+            putState(&state[24], _invert);
+            putState(&state[32], _crc);
+
+            for (int i = 0; i < 8; ++i)
+            {
+                state[40 + i] = static_cast<uint8_t>(_bits >> (8 * i));
+            }
+
+            return state;
+        }
+
+        /**
+         * Continue a calculation from an exported state.
+         * @param state the state, as returned by exportState()
+         * @param len   the number of bytes in state
+         * @return false if state is not a state of this algorithm. The stream is not changed then.
+         */
+        bool importState(uint8_t const* state, size_t len)
+        {
+            if (len != stateSize || std::memcmp(state, stateMagic(), 4) != 0 || state[4] != stateVersion ||
+                state[5] != P::numbits || state[6] != (P::reflected ? 1 : 0) ||
+                getState(&state[8]) != _algorithm.generator() || getState(&state[16]) != _preset ||
+                getState(&state[24]) != _invert)
+            {
+                return false;
+            }
+
+            _crc = getState(&state[32]);
+            _bits = 0;
+
+            for (int i = 7; i >= 0; --i)
+            {
+                _bits = (_bits << 8) | state[40 + i];
+            }
+
+            return true;
         }
 
         /// Get the preset value
@@ -292,7 +416,7 @@ namespace CrcPP
          *
          * @see gen (D const &data)
          */
-        template<typename D> CRCResult<P> gen(D const* data, unsigned int len)
+        template<typename D> CRCResult<P> gen(D const* data, size_t len)
         {
             process<D>(data, len);
             return result();
@@ -318,7 +442,7 @@ namespace CrcPP
          * @see check (D const &data)
          *
          */
-        template<typename D> bool check(D const* data, unsigned int len)
+        template<typename D> bool check(D const* data, size_t len)
         {
             process<D>(data, len);
             return good();
@@ -342,14 +466,10 @@ namespace CrcPP
          * @param	data A pointer to the first byte of the sequence
          * @param	len The length of the sequence
          */
-        template <typename D> void process(D const* data, unsigned int len)
+        template <typename D> void process(D const* data, size_t len)
         {
             reset();
-
-            for (unsigned int i = 0; i < len; ++i)
-            {
-                *this << data[i];
-            }
+            insert(data, len, isByte<D>());
         }
 
         /**
@@ -362,11 +482,213 @@ namespace CrcPP
             *this << data;
         }
 
+#if !defined (WIN32)
+
+        /**
+         * Add data from a scatter/gather list
+         * @param	iov the buffers, as for writev()
+         * @param	count the number of buffers
+         */
+        CRCStream<P>& add(struct iovec const* iov, size_t count)
+        {
+            _algorithm.add(iov, count, _crc);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                _bits += 8 * static_cast<uint64_t>(iov[i].iov_len);
+            }
+
+            return *this;
+        }
+
+        /**
+         * Generate CRC for data in a scatter/gather list
+         * @param	iov the buffers, as for writev()
+         * @param	count the number of buffers
+         */
+        CRCResult<P> gen(struct iovec const* iov, size_t count)
+        {
+            process(iov, count);
+            return result();
+        }
+
+        /**
+         * Check CRC for data in a scatter/gather list.
+         * The CRC is expected at the end of the last buffer, but it may as well be split across buffers.
+         * @param	iov the buffers, as for readv()
+         * @param	count the number of buffers
+         */
+        bool check(struct iovec const* iov, size_t count)
+        {
+            process(iov, count);
+            return good();
+        }
+
+        /**
+         * process a scatter/gather list
+         * @param	iov the buffers, as for writev()
+         * @param	count the number of buffers
+         */
+        void process(struct iovec const* iov, size_t count)
+        {
+            reset();
+            add(iov, count);
+        }
+
+#endif
+
+        /**
+         * Add data from a sequence of buffers, for example a std::vector<std::string>
+         * @param	segments any iterable collection of contiguous byte containers.
+         *          Each element must provide data() and size(), and its elements must be bytes.
+         */
+        template <class C> CRCStream<P>& addSegments(C const& segments)
+        {
+            typename C::const_iterator it;
+
+            for (it = segments.begin(); it != segments.end(); ++it)
+            {
+                if (it->size() > 0)
+                {
+                    _algorithm.add(reinterpret_cast<uint8_t const*>(&*it->begin()), it->size(), _crc);
+                    _bits += 8 * static_cast<uint64_t>(it->size());
+                }
+            }
+
+            return *this;
+        }
+
+        /// Size of an exported state in bytes
+        static size_t const stateSize = 48;
+
     private:
+        /// Whether D is a byte type, which the bulk kernel can add
+        template <class D> struct isByte :
+            std::integral_constant<bool, std::is_same<D, char>::value || std::is_same<D, signed char>::value || std::is_same<D, unsigned char>::value>
+        {
+        };
+
+        /// Whether D is a string or vector of bytes, whose elements are contiguous
+        template <class D> struct isContiguousBytes :
+            std::false_type
+        {
+        };
+
+        template <class C, class T, class A> struct isContiguousBytes<std::basic_string<C, T, A> > :
+            isByte<C>
+        {
+        };
+
+        template <class C, class A> struct isContiguousBytes<std::vector<C, A> > :
+            isByte<C>
+        {
+        };
+
+        /// Add a sequence of bytes in one go
+        template <typename D> void insert(D const* data, size_t len, std::true_type)
+        {
+            add(reinterpret_cast<uint8_t const*>(data), len);
+        }
+
+        /// Add a sequence of other data one element at a time
+        template <typename D> void insert(D const* data, size_t len, std::false_type)
+        {
+            for (size_t i = 0; i < len; ++i)
+            {
+                *this << data[i];
+            }
+        }
+
+        /// Add a string or vector of bytes in one go
+        template <class D> CRCStream<P>& insert(D const& data, std::true_type)
+        {
+            return data.empty() ? *this : add(reinterpret_cast<uint8_t const*>(&data[0]), data.size());
+        }
+
+        /// Add another collection one element at a time
+        template <class D> CRCStream<P>& insert(D const& data, std::false_type)
+        {
+#ifdef  	__cpp_range_based_for
+
+            for (auto const& byte : data)
+            {
+                _algorithm.add(byte, _crc);
+                _bits += 8;
+            }
+
+#else
+            typename D::const_iterator it;
+
+            for (it = data.begin(); it != data.end(); ++it)
+            {
+                _algorithm.add(*it, _crc);
+                _bits += 8;
+            }
+
+#endif
+
+            return *this;
+        }
+
+        /// Record the result of checking in the metrics
+        bool counted(bool good) const
+        {
+            MetricsHook* metrics = MetricsHook::get();
+
+            if (metrics != 0)
+            {
+                metrics->recordResult(static_cast<uint64_t>(static_cast<typename P::data_type>(_algorithm.generator())), P::numbits, P::reflected, good);
+            }
+
+            return good;
+        }
+
+        static char const* stateMagic()
+        {
+            return "CRCs";
+        }
+
+        static void putState(uint8_t* p, P const& value)
+        {
+            uint64_t v = static_cast<typename P::data_type>(value);
+
+            for (int i = 0; i < 8; ++i)
+            {
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        }
+
+        static P getState(uint8_t const* p)
+        {
+            uint64_t v = 0;
+
+            for (int i = 7; i >= 0; --i)
+            {
+                v = (v << 8) | p[i];
+            }
+
+            return P(static_cast<typename P::data_type>(v));
+        }
+
+        static uint8_t const stateVersion = 1;
+
         CRCalgorithm    _algorithm;
         P               _crc;
         P const         _preset;
         P const         _invert;
+        uint64_t        _bits;
 
     };
+
+#if defined (CRCPP_EXTERN_TEMPLATES)
+    // The standard polynomials are instantiated once, in the crcpp library
+    extern template class CRCStream<Poly64N>;
+    extern template class CRCStream<Poly32N>;
+    extern template class CRCStream<Poly16N>;
+    extern template class CRCStream<Poly8N>;
+    extern template class CRCStream<Poly64>;
+    extern template class CRCStream<Poly32>;
+    extern template class CRCStream<Poly16>;
+    extern template class CRCStream<Poly8>;
+#endif
 }
@@ -0,0 +1,232 @@
+#pragma once
+/*
+ * crcstreambuf.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crcstreambuf.h
+ * @brief Contains a stream buffer which computes a CRC of the data passing through it
+ */
+
+#include "crcstream.h"
+
+#include <streambuf>
+#include <vector>
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief A std::streambuf which adds all data passing through it to a CRCStream
+     *
+     * The crc_streambuf wraps another stream buffer, for example the one of a std::ifstream or std::ofstream,
+     * and forwards all data to or from it. On its way, the data is added to a CRCStream in blocks, so the CRC
+     * is available without a second pass over the data and without an extra copy. Large reads and writes
+     * bypass the internal buffer.
+     *
+     * For output, data is added to the CRC when the buffer is flushed. Call std::ostream::flush()
+     * before looking at the CRC.
+     *
+     * For input, data is added to the CRC when the buffer is filled from the wrapped stream buffer.
+     * If the data is read up to its end, the CRC covers exactly the data read. If reading stops before,
+     * the CRC also covers the data read ahead into the buffer.
+     *
+     * A crc_streambuf is meant to be used either for input or for output. Both use the same CRCStream.
+     *
+     * Example:
+     * @code
+     * std::ifstream file("data.bin", std::ios::binary);
+     * CrcPP::crc_streambuf<Poly32N> buffer(file.rdbuf(), cs);
+     * std::istream in(&buffer);
+     * // ... read from in ...
+     * bool ok = cs.good();
+     * @endcode
+     */
+    template <class P> class crc_streambuf :
+        public std::streambuf
+    {
+    public:
+        /**
+         * Constructor.
+         * @param target      The stream buffer to read from or write to
+         * @param crc         The CRCStream to add the data to. It is not reset.
+         * @param bufferSize  The size of the internal buffer in bytes
+         */
+        crc_streambuf(std::streambuf* target, CRCStream<P>& crc, size_t bufferSize = 65536) :
+            _target(target),
+            _crc(crc),
+            _bufferSize(bufferSize > 0 ? bufferSize : 1)
+        {
+        }
+
+        /// Destructor. Pending output is written to the wrapped stream buffer.
+        virtual ~crc_streambuf()
+        {
+            flushOutput();
+        }
+
+    protected:
+        /// Fill the input buffer from the wrapped stream buffer
+        virtual int_type underflow()
+        {
+            if (gptr() < egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            if (_in.empty())
+            {
+                _in.resize(_bufferSize);
+            }
+
+            std::streamsize got = _target->sgetn(&_in[0], static_cast<std::streamsize>(_in.size()));
+
+            if (got <= 0)
+            {
+                return traits_type::eof();
+            }
+
+            addToCrc(&_in[0], got);
+            setg(&_in[0], &_in[0], &_in[0] + got);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        /// Read a block. Blocks larger than the buffer are read directly into the destination.
+        virtual std::streamsize xsgetn(char* s, std::streamsize n)
+        {
+            std::streamsize done = 0;
+            std::streamsize buffered = egptr() - gptr();
+
+            if (buffered > 0)
+            {
+                done = buffered < n ? buffered : n;
+                traits_type::copy(s, gptr(), static_cast<size_t>(done));
+                gbump(static_cast<int>(done));
+            }
+
+            if (n - done >= static_cast<std::streamsize>(_bufferSize))
+            {
+                std::streamsize got = _target->sgetn(s + done, n - done);
+
+                if (got > 0)
+                {
+                    addToCrc(s + done, got);
+                    done += got;
+                }
+
+                return done;
+            }
+
+            return done + std::streambuf::xsgetn(s + done, n - done);
+        }
+
+        /// Flush the output buffer and store c into the empty buffer
+        virtual int_type overflow(int_type c)
+        {
+            if (!flushOutput())
+            {
+                return traits_type::eof();
+            }
+
+            if (_out.empty())
+            {
+                _out.resize(_bufferSize);
+                setp(&_out[0], &_out[0] + _out.size());
+            }
+
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+
+            return traits_type::not_eof(c);
+        }
+
+        /// Write a block. Blocks larger than the buffer are written directly from the source.
+        virtual std::streamsize xsputn(char const* s, std::streamsize n)
+        {
+            if (n < static_cast<std::streamsize>(_bufferSize))
+            {
+                return std::streambuf::xsputn(s, n);
+            }
+
+            if (!flushOutput())
+            {
+                return 0;
+            }
+
+            std::streamsize written = _target->sputn(s, n);
+
+            if (written > 0)
+            {
+                addToCrc(s, written);
+            }
+
+            return written;
+        }
+
+        /// Flush pending output and synchronise the wrapped stream buffer
+        virtual int sync()
+        {
+            return flushOutput() ? _target->pubsync() : -1;
+        }
+
+    private:
+        crc_streambuf(crc_streambuf const&);
+        crc_streambuf& operator=(crc_streambuf const&);
+
+        void addToCrc(char const* data, std::streamsize len)
+        {
+            _crc.add(reinterpret_cast<uint8_t const*>(data), static_cast<size_t>(len));
+        }
+
+        bool flushOutput()
+        {
+            std::streamsize pending = pptr() - pbase();
+
+            if (pending == 0)
+            {
+                return true;
+            }
+
+            std::streamsize written = _target->sputn(pbase(), pending);
+
+            if (written <= 0)
+            {
+                return false;
+            }
+
+            // Keep what the wrapped stream buffer did not take, so a later flush may write it
+            addToCrc(pbase(), written);
+            traits_type::move(&_out[0], pbase() + written, static_cast<size_t>(pending - written));
+            setp(&_out[0], &_out[0] + _out.size());
+            pbump(static_cast<int>(pending - written));
+            return written == pending;
+        }
+
+        std::streambuf*     _target;
+        CRCStream<P>&       _crc;
+        size_t              _bufferSize;
+        std::vector<char>   _in;
+        std::vector<char>   _out;
+    };
+}
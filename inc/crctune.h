@@ -0,0 +1,593 @@
+#pragma once
+/*
+ * crctune.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/**
+ * @file crctune.h
+ * @brief Contains the kernel tuner, which measures the kernels and tables on the CPU it runs on, and caches the results
+ */
+
+#include "crc.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined (WIN32)
+#  include <direct.h>
+#  include <process.h>
+#else
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace CrcPP
+{
+    /**
+     * @ingroup CRCpp
+     * @brief Selects kernels and tables by measuring them on the CPU the program runs on
+     *
+     * Which kernel is fastest depends on the length of the data as much as on the CPU: a lookup per byte
+     * may beat slicing for a few bytes, and folding only pays off for longer data. The crossover points
+     * differ between CPU generations, so the tuner measures each kernel supported for a polynomial and
+     * tables for each size class of data (see sizeClass()), and selects the fastest kernel for each class
+     * with CRC::setKernels(). A kernel only replaces the one of the next longer class if it is more than
+     * 5% faster, so measurement noise does not split the classes.
+     *
+     * The results are cached in a file for each CPU model, by default in the directory crcpp of the
+     * user's cache directory ($XDG_CACHE_HOME or ~/.cache, %LOCALAPPDATA% on Windows). The environment
+     * variable CRCPP_TUNING names another file, or disables the cache if it is empty. Results for kernels
+     * which are not supported any more, e.g. in a virtual machine which hides AVX, are measured again.
+     * If the environment variable CRCPP_KERNEL names a kernel, that kernel is used, and nothing is measured.
+     *
+     * Measuring a polynomial takes a fraction of a second for one table layout, and a few seconds for all.
+     */
+    class KernelTuner
+    {
+    public:
+        /**
+         * The kernel selected for a size class
+         */
+        struct Choice
+        {
+            Kernel kernel;
+            double speed;       ///< measured in MB/s
+        };
+
+        /**
+         * The kernels selected for a polynomial and tables
+         */
+        struct Tuning
+        {
+            Choice choices[numSizeClasses];
+        };
+
+        /**
+         * Constructor. Loads the cache, if there is one.
+         * @param path the cache file, empty for no cache. See defaultPath().
+         */
+        explicit KernelTuner(std::string const& path = defaultPath()) :
+            _path(path)
+        {
+            load();
+        }
+
+        /// @return the tuner used by the crc tool, with the default cache
+        static KernelTuner& shared()
+        {
+            static KernelTuner tuner;
+            return tuner;
+        }
+
+        /// @return the file named by CRCPP_TUNING, or the file for this CPU model in the user's cache directory
+        static std::string defaultPath()
+        {
+            char const* file = std::getenv("CRCPP_TUNING");
+
+            if (file != 0)
+            {
+                return file;
+            }
+
+            std::string dir;
+#if defined (WIN32)
+            char const* local = std::getenv("LOCALAPPDATA");
+
+            if (local != 0)
+            {
+                dir = local;
+            }
+#else
+            char const* cache = std::getenv("XDG_CACHE_HOME");
+            char const* home = std::getenv("HOME");
+
+            if (cache != 0 && *cache != 0)
+            {
+                dir = cache;
+            }
+            else if (home != 0 && *home != 0)
+            {
+                dir = std::string(home) + "/.cache";
+            }
+#endif
+
+            return dir.empty() ? dir : dir + "/crcpp/" + modelName() + ".tune";
+        }
+
+        /// @return the CPU model, with anything but letters and digits replaced by '-'
+        static std::string modelName()
+        {
+            std::string const& model = CPUFeatures::get().model;
+            std::string name;
+
+            for (size_t i = 0; i < model.size(); ++i)
+            {
+                bool alnum = (model[i] >= 'A' && model[i] <= 'Z') || (model[i] >= 'a' && model[i] <= 'z') || (model[i] >= '0' && model[i] <= '9');
+
+                if (alnum)
+                {
+                    name += model[i];
+                }
+                else if (!name.empty() && name[name.size() - 1] != '-')
+                {
+                    name += '-';
+                }
+            }
+
+            while (!name.empty() && name[name.size() - 1] == '-')
+            {
+                name.erase(name.size() - 1);
+            }
+
+            return name.empty() ? "unknown-cpu" : name;
+        }
+
+        /// @return the cache file
+        std::string const& path() const
+        {
+            return _path;
+        }
+
+        /**
+         * Select the cached kernels for a CRC.
+         * @param crc the CRC
+         * @return false if nothing usable is cached for the polynomial and tables of crc, or CRCPP_KERNEL names a kernel
+         */
+        template <class P> bool apply(CRC<P>& crc) const
+        {
+            Tuning tuning;
+
+            if (forced() || !find(crc.generator(), crc.tables(), tuning) || !usable(crc, tuning))
+            {
+                return false;
+            }
+
+            Kernel kernels[numSizeClasses];
+
+            for (size_t i = 0; i < numSizeClasses; ++i)
+            {
+                kernels[i] = tuning.choices[i].kernel;
+            }
+
+            crc.setKernels(kernels);
+            return true;
+        }
+
+        /**
+         * Select the cached kernels for a CRC, or measure them and save them to the cache
+         * @param crc the CRC
+         */
+        template <class P> void tune(CRC<P>& crc)
+        {
+            if (forced() || apply(crc))
+            {
+                return;
+            }
+
+            measure(crc);
+            apply(crc);
+            save();
+        }
+
+        /**
+         * Create a CRC with the fastest tables and kernels. The table layout is chosen by the sum of the speeds
+         * of all size classes, relative to the fastest layout for each class. Smaller tables are preferred unless
+         * larger ones are more than 2% faster.
+         * @param generator the generator polynomial
+         * @param measure   whether to measure the layouts which are not cached, and save them to the cache.
+         *                  Otherwise, only cached layouts are considered, and the defaults are used if there are none.
+         * @return the CRC
+         */
+        template <class P> CRC<P> create(P const generator, bool measure = true)
+        {
+            static Tables const layouts[] = { TablesNone, TablesByte, TablesSlicing4, TablesSlicing8, TablesSlicing16, TablesWord };
+            static size_t const numLayouts = sizeof(layouts) / sizeof(layouts[0]);
+
+            if (forced())
+            {
+                return CRC<P>(generator);
+            }
+
+            Tuning tunings[numLayouts];
+            bool found[numLayouts] = { false };
+            bool measured = false;
+
+            for (size_t i = 0; i < numLayouts; ++i)
+            {
+                if (find(generator, layouts[i], tunings[i]))
+                {
+                    found[i] = true;
+                }
+                else if (measure)
+                {
+                    try
+                    {
+                        tunings[i] = this->measure(CRC<P>(generator, layouts[i]));
+                        found[i] = measured = true;
+                    }
+                    catch (std::logic_error const&)
+                    {
+                        // The tables do not fit the polynomial
+                    }
+                }
+            }
+
+            if (measured)
+            {
+                save();
+            }
+
+            double best[numSizeClasses] = { 0 };
+
+            for (size_t i = 0; i < numLayouts; ++i)
+            {
+                for (size_t c = 0; found[i] && c < numSizeClasses; ++c)
+                {
+                    best[c] = std::max(best[c], tunings[i].choices[c].speed);
+                }
+            }
+
+            Tables tables = CRC<P>::defaultTables();
+            double bestScore = 0;
+
+            for (size_t i = 0; i < numLayouts; ++i)
+            {
+                double score = 0;
+
+                for (size_t c = 0; found[i] && c < numSizeClasses; ++c)
+                {
+                    score += best[c] > 0 ? tunings[i].choices[c].speed / best[c] : 0;
+                }
+
+                if (score > bestScore * 1.02)
+                {
+                    tables = layouts[i];
+                    bestScore = score;
+                }
+            }
+
+            CRC<P> crc(generator, tables);
+            apply(crc);
+            return crc;
+        }
+
+        /**
+         * Measure the kernels for a CRC, and keep the result in the cache. The cache is not saved.
+         * @param crc the CRC, whose kernels are not changed
+         * @return the selected kernels
+         */
+        template <class P> Tuning measure(CRC<P> const& crc)
+        {
+            CRC<P> trial(crc);
+            std::vector<uint8_t> buffer(bufferSize);
+            uint32_t random = 0x12345678;
+
+            for (size_t i = 0; i < buffer.size(); ++i)
+            {
+                random = random * 1103515245U + 12345U;
+                buffer[i] = static_cast<uint8_t>(random >> 24);
+            }
+
+            double speeds[numSizeClasses][numKernels] = { { 0 } };
+
+            for (int kernel = KernelTable; kernel < numKernels; ++kernel)
+            {
+                if (!trial.supports(static_cast<Kernel>(kernel)))
+                {
+                    continue;
+                }
+
+                trial.setKernel(static_cast<Kernel>(kernel));
+
+                for (size_t c = 0; c < numSizeClasses; ++c)
+                {
+                    speeds[c][kernel] = speed(trial, buffer, sampleLength(c));
+                }
+            }
+
+            // From the longest data down, keep the kernel unless another one is clearly faster
+            Tuning tuning;
+            int previous = KernelAuto;
+
+            for (size_t c = numSizeClasses; c-- > 0; )
+            {
+                int fastest = KernelTable;
+
+                for (int kernel = KernelTable; kernel < numKernels; ++kernel)
+                {
+                    if (speeds[c][kernel] > speeds[c][fastest])
+                    {
+                        fastest = kernel;
+                    }
+                }
+
+                if (previous != KernelAuto && speeds[c][previous] * 1.05 >= speeds[c][fastest])
+                {
+                    fastest = previous;
+                }
+
+                tuning.choices[c].kernel = static_cast<Kernel>(fastest);
+                tuning.choices[c].speed = speeds[c][fastest];
+                previous = fastest;
+            }
+
+            std::lock_guard<std::mutex> lock(_lock);
+            _tunings[key(crc.generator(), crc.tables())] = tuning;
+            return tuning;
+        }
+
+        /**
+         * Look up the cached kernels for a polynomial and tables
+         * @param generator the generator polynomial
+         * @param tables    the tables
+         * @param tuning    receives the kernels
+         * @return whether the kernels are cached
+         */
+        template <class P> bool find(P const generator, Tables tables, Tuning& tuning) const
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            std::map<std::string, Tuning>::const_iterator it = _tunings.find(key(generator, tables));
+
+            if (it == _tunings.end())
+            {
+                return false;
+            }
+
+            tuning = it->second;
+            return true;
+        }
+
+        /**
+         * Discard the cached kernels for all tables of a polynomial, so they are measured again
+         * @param generator the generator polynomial
+         */
+        template <class P> void forget(P const generator)
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            std::string prefix = key(generator, TablesNone);
+            prefix.erase(prefix.rfind(' ') + 1);
+
+            for (std::map<std::string, Tuning>::iterator it = _tunings.lower_bound(prefix); it != _tunings.end() && it->first.compare(0, prefix.size(), prefix) == 0; )
+            {
+                _tunings.erase(it++);
+            }
+        }
+
+        /**
+         * Save the cache. The file is replaced as a whole, so concurrent readers see either the old or the new one.
+         * @return false if there is no cache file, or it cannot be written
+         */
+        bool save() const
+        {
+            if (_path.empty())
+            {
+                return false;
+            }
+
+            makeDirectories(_path);
+            std::ostringstream temp;
+#if defined (WIN32)
+            temp << _path << '.' << _getpid();
+#else
+            temp << _path << '.' << getpid();
+#endif
+
+            {
+                std::ofstream file(temp.str().c_str());
+                file << "# CRC++ kernel tuning for " << CPUFeatures::get().model << std::endl;
+                file << "# bits generator tables, then kernel and MB/s below 16, 64, 256, 1K, 4K bytes and above" << std::endl;
+
+                std::lock_guard<std::mutex> lock(_lock);
+
+                for (std::map<std::string, Tuning>::const_iterator it = _tunings.begin(); it != _tunings.end(); ++it)
+                {
+                    file << it->first;
+
+                    for (size_t c = 0; c < numSizeClasses; ++c)
+                    {
+                        file << ' ' << kernelName(it->second.choices[c].kernel) << ' ' << static_cast<unsigned long>(it->second.choices[c].speed + 0.5);
+                    }
+
+                    file << std::endl;
+                }
+
+                if (!file)
+                {
+                    std::remove(temp.str().c_str());
+                    return false;
+                }
+            }
+
+#if defined (WIN32)
+            std::remove(_path.c_str());
+#endif
+            return std::rename(temp.str().c_str(), _path.c_str()) == 0;
+        }
+
+        /**
+         * The name of a table layout, as used in the cache
+         * @param tables the tables
+         * @return the name of the tables
+         */
+        static char const* tablesName(Tables tables)
+        {
+            static char const* const names[] = { "none", "nibble", "byte", "slicing4", "slicing8", "slicing16", "word" };
+            return tables <= TablesWord ? names[tables] : "unknown";
+        }
+
+    private:
+        /// The size of the data for measurements: more than the longest sample, and within the L2 cache
+        static size_t const bufferSize = 64 * 1024;
+
+        KernelTuner(KernelTuner const&);
+        KernelTuner& operator = (KernelTuner const&);
+
+        /// @return the length of the data measured for a size class: in the middle of the class
+        static size_t sampleLength(size_t sizeClass)
+        {
+            return sizeClass + 1 < numSizeClasses ? static_cast<size_t>(8) << (2 * sizeClass) : 16384;
+        }
+
+        /// @return the best of three runs in MB/s, each long enough for a millisecond
+        template <class P> static double speed(CRC<P> const& crc, std::vector<uint8_t> const& buffer, size_t len)
+        {
+            typedef std::chrono::steady_clock clock;
+            volatile typename P::data_type sink = 0;
+            size_t calls = 1;
+            double best = 0;
+
+            for (int run = 0; run < 3; )
+            {
+                clock::time_point start = clock::now();
+                P reg = 0;
+
+                for (size_t i = 0, offset = 0; i < calls; ++i)
+                {
+                    crc.add(&buffer[offset], len, reg);
+                    offset = offset + 2 * len > buffer.size() ? 0 : offset + len;
+                }
+
+                double seconds = std::chrono::duration<double>(clock::now() - start).count();
+                sink = static_cast<typename P::data_type>(reg);
+
+                if (seconds < 0.001)
+                {
+                    calls *= 2;
+                    continue;
+                }
+
+                best = std::max(best, static_cast<double>(calls) * len / seconds / 1e6);
+                ++run;
+            }
+
+            (void)sink;
+            return best;
+        }
+
+        template <class P> static std::string key(P const generator, Tables tables)
+        {
+            std::ostringstream s;
+            s << P::numbits << (P::reflected ? "N " : " ") << std::hex << std::uppercase << std::setfill('0') << std::setw((P::numbits + 3) / 4)
+              << static_cast<uint64_t>(static_cast<typename P::data_type>(generator)) << ' ' << tablesName(tables);
+            return s.str();
+        }
+
+        /// @return whether all kernels of a tuning are supported
+        template <class P> static bool usable(CRC<P> const& crc, Tuning const& tuning)
+        {
+            for (size_t c = 0; c < numSizeClasses; ++c)
+            {
+                if (!crc.supports(tuning.choices[c].kernel))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// @return whether CRCPP_KERNEL names a kernel
+        static bool forced()
+        {
+            return kernelFromName(std::getenv("CRCPP_KERNEL")) != KernelAuto;
+        }
+
+        /// Create the directories of a file path, ignoring errors: they show up when the file is written
+        static void makeDirectories(std::string const& path)
+        {
+            for (size_t pos = path.find_first_of("/\\", 1); pos != std::string::npos; pos = path.find_first_of("/\\", pos + 1))
+            {
+#if defined (WIN32)
+                _mkdir(path.substr(0, pos).c_str());
+#else
+                mkdir(path.substr(0, pos).c_str(), 0755);
+#endif
+            }
+        }
+
+        void load()
+        {
+            if (_path.empty())
+            {
+                return;
+            }
+
+            std::ifstream file(_path.c_str());
+            std::string line;
+
+            while (std::getline(file, line))
+            {
+                std::istringstream s(line);
+                std::string bits, generator, tables;
+
+                if (line.empty() || line[0] == '#' || !(s >> bits >> generator >> tables))
+                {
+                    continue;
+                }
+
+                Tuning tuning;
+                bool ok = true;
+
+                for (size_t c = 0; c < numSizeClasses && ok; ++c)
+                {
+                    std::string name;
+                    ok = (s >> name >> tuning.choices[c].speed) && (tuning.choices[c].kernel = kernelFromName(name.c_str())) != KernelAuto;
+                }
+
+                if (ok)
+                {
+                    _tunings[bits + ' ' + generator + ' ' + tables] = tuning;
+                }
+            }
+        }
+
+        std::string _path;
+        std::map<std::string, Tuning> _tunings;     ///< by polynomial and tables, see key()
+        mutable std::mutex _lock;
+    };
+}
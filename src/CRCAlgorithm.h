@@ -27,6 +27,7 @@
 
 #include "crc.h"
 #include "crcstream.h"
+#include "crctune.h"
 
 #include <string>
 
@@ -40,7 +41,7 @@ template<class P> class CRCAlgorithm :
 {
 public:
     CRCAlgorithm(P const generator, typename P::data_type preset = ~0, typename P::data_type invert = ~0) :
-        crcAlgorithm(generator),
+        crcAlgorithm(create(generator)),
         crcStream(crcAlgorithm, preset, invert)
     {
     }
@@ -51,10 +52,32 @@ public:
     }
 
 private:
+    /**
+     * The tuner reads the CPU model and its cache, which costs more than most invocations of the tool.
+     * It is only consulted if the environment variable CRCPP_TUNING names the tuning file.
+     */
+    static CrcPP::CRC<P> create(P const generator)
+    {
+        char const* tuning = std::getenv("CRCPP_TUNING");
+        return tuning != 0 && *tuning != 0 ? CrcPP::KernelTuner::shared().create(generator, false) : CrcPP::CRC<P>(generator);
+    }
+
     void addByte(uint8_t b)
     {
         crcStream << b;
     }
+    void addBytes(uint8_t const* data, size_t len)
+    {
+        crcStream.add(data, len);
+    }
+    void copyBytes(uint8_t* dst, uint8_t const* src, size_t len)
+    {
+        crcStream.copyAndAdd(dst, src, len);
+    }
+    void addZeros(size_t n)
+    {
+        crcStream.addZeros(n);
+    }
     void reset()
     {
         crcStream.reset();
@@ -68,6 +91,57 @@ private:
         CrcPP::CRCResult<P> res = crcStream.result();
         return std::basic_string<uint8_t>(res.c_str(), res.size());
     }
+    void checkFrames(uint8_t const* const* someFrames, size_t const* someLengths, bool* someResults, size_t aCount) const
+    {
+        P goodcrc = 0;
+        crcAlgorithm.add(crcStream.invert(), goodcrc);
+
+        P regs[batchSize];
+
+        for (size_t done = 0; done < aCount; done += batchSize)
+        {
+            size_t n = aCount - done < batchSize ? aCount - done : batchSize;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                regs[i] = crcStream.preset();
+            }
+
+            crcAlgorithm.add(someFrames + done, someLengths + done, regs, n);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                someResults[done + i] = regs[i] == goodcrc;
+            }
+        }
+    }
+
+    uint64_t blockCRC(uint8_t const* data, size_t len) const
+    {
+        P reg = 0;
+        crcAlgorithm.add(data, len, reg);
+        return static_cast<typename P::data_type>(reg);
+    }
+    void addBlock(uint64_t aBlockCRC, size_t len)
+    {
+        crcStream.combine(P(static_cast<typename P::data_type>(aBlockCRC)), len);
+    }
+
+    uint64_t length() const
+    {
+        return crcStream.length();
+    }
+    ByteString exportState() const
+    {
+        std::vector<uint8_t> state = crcStream.exportState();
+        return ByteString(state.begin(), state.end());
+    }
+    bool importState(ByteString const& aState)
+    {
+        return crcStream.importState(aState.data(), aState.size());
+    }
+
+    static size_t const batchSize = 64;
 
     CrcPP::CRC<P> crcAlgorithm;
     CrcPP::CRCStream<P> crcStream;
@@ -0,0 +1,370 @@
+/*
+ * CRCAnalyzer.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "CRCAnalyzer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace
+{
+    uint16_t const noPosition = 0xFFFF;
+
+    // Maximum number of entries in the lookup table (16 bytes each)
+    double const maxTableSize = 16 * 1024 * 1024;
+
+    // Largest subsets in the lookup table
+    unsigned int const maxSubsetSize = 3;
+
+    // Number of subsets of k elements of a set with n elements
+    double binomial(size_t n, unsigned int k)
+    {
+        double result = 1;
+
+        for (unsigned int i = 0; i < k; ++i)
+        {
+            result = result * static_cast<double>(n - i) / (i + 1);
+        }
+
+        return result;
+    }
+}
+
+unsigned int const CRCAnalyzer::maxWeight;
+size_t const CRCAnalyzer::maxLength;
+
+CRCAnalyzer::CRCAnalyzer(std::vector<uint64_t> const& someSyndromes, unsigned int aWidth) :
+    theSyndromes(someSyndromes.begin(), someSyndromes.begin() + std::min(someSyndromes.size(), maxLength)),
+    theWidth(aWidth),
+    theWeight(1),
+    theTableSize(0)
+{
+}
+
+void CRCAnalyzer::run(unsigned int aNumThreads, uint64_t aBudget)
+{
+    size_t n = theSyndromes.size();
+
+    if (aNumThreads == 0)
+    {
+        aNumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    theCounts.assign(maxWeight + 1, std::vector<uint64_t>(n + 1, 0));
+    theWeight = 1;
+
+    for (unsigned int weight = 2; weight <= maxWeight; ++weight)
+    {
+        // Put the larger half into the table, if it fits into memory
+        unsigned int tableSize = std::min(weight - 1, maxSubsetSize);
+
+        while (tableSize > 1 && binomial(n, tableSize) > maxTableSize)
+        {
+            --tableSize;
+        }
+
+        if (binomial(n, weight - tableSize) > static_cast<double>(aBudget))
+        {
+            break;
+        }
+
+        if (tableSize != theTableSize)
+        {
+            buildTable(tableSize);
+        }
+
+        countWeight(weight, aNumThreads);
+        theWeight = weight;
+    }
+
+    std::vector<Entry>().swap(theTable);
+    theTableSize = 0;
+}
+
+unsigned int CRCAnalyzer::countedWeight() const
+{
+    return theWeight;
+}
+
+uint64_t CRCAnalyzer::count(unsigned int aWeight, size_t aLength) const
+{
+    if (aWeight < 2 || aWeight > theWeight)
+    {
+        return 0;
+    }
+
+    return theCounts[aWeight][std::min(aLength, theSyndromes.size())];
+}
+
+unsigned int CRCAnalyzer::distance(size_t aLength) const
+{
+    for (unsigned int weight = 2; weight <= theWeight; ++weight)
+    {
+        if (count(weight, aLength) > 0)
+        {
+            return weight;
+        }
+    }
+
+    return theWeight + 1;
+}
+
+void CRCAnalyzer::buildTable(unsigned int aSize)
+{
+    uint32_t n = static_cast<uint32_t>(theSyndromes.size());
+    theTable.clear();
+    theTable.reserve(static_cast<size_t>(binomial(n, aSize) + 0.5));
+
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        if (aSize == 1)
+        {
+            Entry e = { theSyndromes[i], { i, noPosition, noPosition } };
+            theTable.push_back(e);
+            continue;
+        }
+
+        for (uint16_t j = i + 1; j < n; ++j)
+        {
+            uint64_t pair = theSyndromes[i] ^ theSyndromes[j];
+
+            if (aSize == 2)
+            {
+                Entry e = { pair, { i, j, noPosition } };
+                theTable.push_back(e);
+                continue;
+            }
+
+            for (uint16_t k = j + 1; k < n; ++k)
+            {
+                Entry e = { pair ^ theSyndromes[k], { i, j, k } };
+                theTable.push_back(e);
+            }
+        }
+    }
+
+    std::sort(theTable.begin(), theTable.end());
+    theTableSize = aSize;
+}
+
+void CRCAnalyzer::countWeight(unsigned int aWeight, unsigned int aNumThreads)
+{
+    size_t n = theSyndromes.size();
+    unsigned int subsetSize = aWeight - theTableSize;
+    std::vector<uint64_t>& counts = theCounts[aWeight];
+    std::vector<uint64_t> byTop(n, 0);
+
+    // The highest position of the enumerated subsets is handed out to the threads,
+    // starting with the highest ones, which have the most work.
+    std::atomic<size_t> next(n);
+    std::mutex merge;
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < aNumThreads; ++t)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            std::vector<uint64_t> local(n, 0);
+            size_t top;
+
+            while ((top = next.fetch_sub(1)) > 0 && top <= n)
+            {
+                enumerate(subsetSize, static_cast<uint32_t>(top - 1), local);
+            }
+
+            std::lock_guard<std::mutex> lock(merge);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                byTop[i] += local[i];
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+
+    // Each codeword has been found once for every way to split it into an enumerated subset
+    // and a table entry. Make the counts cumulative by codeword length.
+    uint64_t splits = static_cast<uint64_t>(binomial(aWeight, subsetSize) + 0.5);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        counts[i + 1] = counts[i] + byTop[i] / splits;
+    }
+}
+
+void CRCAnalyzer::enumerate(unsigned int aSize, uint32_t aTop, std::vector<uint64_t>& someCounts) const
+{
+    // Enumerate subsets {aTop, p[1], ..., p[aSize - 1]} with aTop > p[1] > p[2] > ...
+    uint32_t p[maxWeight];
+    uint64_t sum[maxWeight];
+    p[0] = aTop;
+    sum[0] = theSyndromes[aTop];
+    unsigned int depth = 1;
+
+    if (aSize > 1)
+    {
+        p[1] = aTop;
+    }
+
+    while (true)
+    {
+        if (depth < aSize)
+        {
+            // Next candidate at this depth, counting down
+            if (p[depth] == 0)
+            {
+                // Exhausted: back up
+                if (--depth == 0)
+                {
+                    return;
+                }
+
+                continue;
+            }
+
+            --p[depth];
+            sum[depth] = sum[depth - 1] ^ theSyndromes[p[depth]];
+
+            if (depth + 1 < aSize)
+            {
+                ++depth;
+                p[depth] = p[depth - 1];
+                continue;
+            }
+        }
+
+        // Complete subset: look up all table entries with the same syndrome sum
+        uint64_t syndrome = sum[aSize - 1];
+        Entry key = { syndrome, { 0, 0, 0 } };
+
+        for (std::vector<Entry>::const_iterator it = std::lower_bound(theTable.begin(), theTable.end(), key);
+             it != theTable.end() && it->syndrome == syndrome; ++it)
+        {
+            bool disjoint = true;
+            uint32_t highest = aTop;
+
+            for (unsigned int j = 0; j < theTableSize; ++j)
+            {
+                for (unsigned int i = 0; i < aSize; ++i)
+                {
+                    disjoint = disjoint && p[i] != it->position[j];
+                }
+
+                highest = std::max(highest, static_cast<uint32_t>(it->position[j]));
+            }
+
+            if (disjoint)
+            {
+                ++someCounts[highest];
+            }
+        }
+
+        if (aSize == 1)
+        {
+            return;
+        }
+
+        depth = aSize - 1;
+    }
+}
+
+void CRCAnalyzer::report(std::ostream& s) const
+{
+    size_t n = theSyndromes.size();
+
+    if (n <= theWidth)
+    {
+        return;
+    }
+
+    size_t maxData = n - theWidth;
+
+    s << std::dec << std::setfill(' ');
+    s << "Codewords by message length (data bits, not including the CRC)" << std::endl;
+    s << std::setw(10) << "bits" << std::setw(5) << "HD";
+
+    for (unsigned int weight = 2; weight <= theWeight; ++weight)
+    {
+        s << std::setw(14) << "W" << weight;
+    }
+
+    s << std::endl;
+
+    for (size_t bits = 8; ; bits *= 2)
+    {
+        if (bits > maxData)
+        {
+            bits = maxData;
+        }
+
+        size_t length = bits + theWidth;
+        unsigned int hd = distance(length);
+        s << std::setw(10) << bits << std::setw(4) << (hd > theWeight ? ">" : " ") << std::min(hd, theWeight);
+
+        for (unsigned int weight = 2; weight <= theWeight; ++weight)
+        {
+            s << std::setw(15) << count(weight, length);
+        }
+
+        s << std::endl;
+
+        if (bits == maxData)
+        {
+            break;
+        }
+    }
+
+    s << std::endl;
+
+    // Longest message for each Hamming distance
+    for (unsigned int hd = 3; hd <= theWeight + 1; ++hd)
+    {
+        size_t limit = n;
+
+        for (unsigned int weight = 2; weight < hd; ++weight)
+        {
+            // First codeword length with a codeword of this weight
+            std::vector<uint64_t> const& counts = theCounts[weight];
+            size_t first = std::upper_bound(counts.begin(), counts.end(), 0ULL) - counts.begin();
+            limit = std::min(limit, first - 1);
+        }
+
+        s << "HD >= " << hd << ": ";
+
+        if (limit <= theWidth)
+        {
+            s << "none" << std::endl;
+        }
+        else
+        {
+            s << "up to " << limit - theWidth << " data bits" << (limit == n ? " (at least, limit of analysis)" : "") << std::endl;
+        }
+    }
+}
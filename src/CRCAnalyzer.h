@@ -0,0 +1,111 @@
+#pragma once
+/*
+ * CRCAnalyzer.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iosfwd>
+#include <vector>
+
+/**
+ * Computes the weight distribution of the code generated by a CRC polynomial
+ * @ingroup Util
+ *
+ * A codeword of length n is a set of bit positions below n whose single bit syndromes add up to 0:
+ * an error pattern which cannot be detected in messages of that length (including the CRC).
+ * The minimum weight of all codewords is the Hamming distance of the code.
+ *
+ * Codewords are counted by meet in the middle: all subsets of a positions are enumerated, and the
+ * sum of their syndromes is looked up in a sorted table of the syndrome sums of all subsets of b positions
+ * (up to three), for a weight of a + b. The table is made as large as memory permits, so that
+ * as few subsets as possible have to be enumerated. The enumeration is spread over all cores.
+ * The counts are kept per highest position of the codeword, so one run yields the counts for all lengths.
+ */
+class CRCAnalyzer
+{
+public:
+    /// The highest weight that is counted
+    static unsigned int const maxWeight = 6;
+
+    /// The maximum codeword length in bits
+    static size_t const maxLength = 65535;
+
+    /**
+     * Constructor
+     * @param someSyndromes the syndromes of single bit errors at positions 0 ... n - 1, see ICRCInfo::getSyndromes().
+     *        At most maxLength syndromes are used.
+     * @param aWidth the number of bits in the CRC
+     */
+    CRCAnalyzer(std::vector<uint64_t> const& someSyndromes, unsigned int aWidth);
+
+    /**
+     * Count the codewords
+     * @param aNumThreads the number of threads to use, 0 for one per core
+     * @param aBudget the maximum number of subsets to enumerate for one weight. Higher weights are not counted.
+     */
+    void run(unsigned int aNumThreads = 0, uint64_t aBudget = 2000000000ULL);
+
+    /// @return the highest weight that has been counted
+    unsigned int countedWeight() const;
+
+    /**
+     * @param aWeight the weight
+     * @param aLength the codeword length in bits (message including the CRC)
+     * @return the number of codewords of this weight and a length up to aLength
+     */
+    uint64_t count(unsigned int aWeight, size_t aLength) const;
+
+    /**
+     * @param aLength the codeword length in bits
+     * @return the Hamming distance, or countedWeight() + 1 if no codeword has been found
+     */
+    unsigned int distance(size_t aLength) const;
+
+    /**
+     * Write a table of Hamming distance and low weight codeword counts by message length
+     * @param s the stream to write to
+     */
+    void report(std::ostream& s) const;
+
+private:
+    struct Entry
+    {
+        uint64_t syndrome;
+        uint16_t position[3];
+
+        bool operator<(Entry const& other) const
+        {
+            return syndrome < other.syndrome;
+        }
+    };
+
+    void buildTable(unsigned int aSize);
+    void countWeight(unsigned int aWeight, unsigned int aNumThreads);
+    void enumerate(unsigned int aSize, uint32_t aTop, std::vector<uint64_t>& someCounts) const;
+
+    std::vector<uint64_t> theSyndromes;
+    unsigned int theWidth;
+    unsigned int theWeight;
+    std::vector<Entry> theTable;
+    unsigned int theTableSize;
+    std::vector<std::vector<uint64_t> > theCounts;    // [weight][length], cumulative
+};
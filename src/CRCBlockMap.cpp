@@ -0,0 +1,413 @@
+/*
+ * CRCBlockMap.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "CRCBlockMap.h"
+#include "ICRCAlgorithm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+
+#if defined (WIN32)
+#  include <io.h>
+#  define lseek _lseeki64
+typedef int ssize_t;
+#else
+#  include <unistd.h>
+#  define O_BINARY 0
+#endif
+
+namespace
+{
+    char const magic[8] = { 'C', 'R', 'C', 'p', 'p', 'M', 'A', 'P' };
+    uint32_t const version = 1;
+
+    // Magic, version, width, flags, reserved, generator, block size, file size
+    size_t const headerSize = 48;
+    uint32_t const flagNative = 1;
+
+    void put(uint8_t* p, uint64_t aValue, unsigned int aSize)
+    {
+        for (unsigned int i = 0; i < aSize; ++i)
+        {
+            p[i] = static_cast<uint8_t>(aValue >> (8 * i));
+        }
+    }
+
+    uint64_t get(uint8_t const* p, unsigned int aSize)
+    {
+        uint64_t value = 0;
+
+        for (unsigned int i = aSize; i > 0; --i)
+        {
+            value = (value << 8) | p[i - 1];
+        }
+
+        return value;
+    }
+
+    // Read exactly aLength bytes at anOffset, unless the file ends before
+    ssize_t readAt(int aFile, uint8_t* someData, size_t aLength, uint64_t anOffset)
+    {
+        size_t done = 0;
+
+        while (done < aLength)
+        {
+#if defined (WIN32)
+            static std::mutex seek;
+            std::lock_guard<std::mutex> lock(seek);
+            ssize_t got = ::lseek(aFile, static_cast<int64_t>(anOffset + done), SEEK_SET) < 0 ? -1 :
+                          ::read(aFile, someData + done, static_cast<unsigned int>(aLength - done));
+#else
+            ssize_t got = ::pread(aFile, someData + done, aLength - done, static_cast<off_t>(anOffset + done));
+#endif
+
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            if (got <= 0)
+            {
+                return got < 0 ? got : static_cast<ssize_t>(done);
+            }
+
+            done += static_cast<size_t>(got);
+        }
+
+        return static_cast<ssize_t>(done);
+    }
+
+    // Closes a file when leaving the scope
+    class FileGuard
+    {
+    public:
+        explicit FileGuard(int aFile) : theFile(aFile) {}
+        ~FileGuard()
+        {
+            if (theFile >= 0)
+            {
+                ::close(theFile);
+            }
+        }
+
+    private:
+        int theFile;
+    };
+}
+
+CRCBlockMap::CRCBlockMap(ICRCAlgorithm const& anAlgorithm, uint64_t aGenerator, unsigned int aWidth, bool aNative) :
+    theAlgorithm(anAlgorithm),
+    theGenerator(aGenerator),
+    theWidth(aWidth),
+    isNative(aNative),
+    theBlockSize(defaultBlockSize),
+    theFileSize(0)
+{
+}
+
+bool CRCBlockMap::build(char const* aName, uint64_t aBlockSize, unsigned int aNumThreads)
+{
+    int file = ::open(aName, O_RDONLY | O_BINARY);
+    FileGuard guard(file);
+
+    if (file < 0)
+    {
+        return fail(std::string("cannot open ") + aName + ": " + std::strerror(errno));
+    }
+
+    // The size of block devices is only known by seeking to the end
+    int64_t size = ::lseek(file, 0, SEEK_END);
+
+    if (size < 0 || aBlockSize == 0)
+    {
+        return fail(std::string("cannot determine the size of ") + aName);
+    }
+
+    theBlockSize = aBlockSize;
+    theFileSize = static_cast<uint64_t>(size);
+    theCRCs.assign((theFileSize + theBlockSize - 1) / theBlockSize, 0);
+    return compute(file, 0, theCRCs.size(), theCRCs, aNumThreads);
+}
+
+bool CRCBlockMap::load(char const* aName)
+{
+    int file = ::open(aName, O_RDONLY | O_BINARY);
+    FileGuard guard(file);
+    uint8_t header[headerSize];
+
+    if (file < 0 || readAt(file, header, headerSize, 0) != static_cast<ssize_t>(headerSize))
+    {
+        return fail(std::string("cannot read ") + aName + ": " + std::strerror(errno));
+    }
+
+    if (std::memcmp(header, magic, sizeof(magic)) != 0 || get(header + 8, 4) != version)
+    {
+        return fail(std::string(aName) + " is not a block map");
+    }
+
+    if (get(header + 12, 4) != theWidth || ((get(header + 16, 4) & flagNative) != 0) != isNative ||
+        get(header + 24, 8) != theGenerator)
+    {
+        return fail(std::string(aName) + " was built with another polynomial");
+    }
+
+    theBlockSize = get(header + 32, 8);
+    theFileSize = get(header + 40, 8);
+
+    if (theBlockSize == 0)
+    {
+        return fail(std::string(aName) + " is damaged");
+    }
+
+    unsigned int crcSize = (theWidth + 7) / 8;
+    uint64_t count = (theFileSize + theBlockSize - 1) / theBlockSize;
+    std::vector<uint8_t> data(static_cast<size_t>(count * crcSize));
+
+    if (!data.empty() && readAt(file, &data[0], data.size(), headerSize) != static_cast<ssize_t>(data.size()))
+    {
+        return fail(std::string(aName) + " is truncated");
+    }
+
+    theCRCs.resize(static_cast<size_t>(count));
+
+    for (size_t i = 0; i < theCRCs.size(); ++i)
+    {
+        theCRCs[i] = get(&data[i * crcSize], crcSize);
+    }
+
+    return true;
+}
+
+bool CRCBlockMap::save(char const* aName)
+{
+    unsigned int crcSize = (theWidth + 7) / 8;
+    std::vector<uint8_t> data(headerSize + theCRCs.size() * crcSize);
+
+    std::memcpy(&data[0], magic, sizeof(magic));
+    put(&data[8], version, 4);
+    put(&data[12], theWidth, 4);
+    put(&data[16], isNative ? flagNative : 0, 4);
+    put(&data[24], theGenerator, 8);
+    put(&data[32], theBlockSize, 8);
+    put(&data[40], theFileSize, 8);
+
+    for (size_t i = 0; i < theCRCs.size(); ++i)
+    {
+        put(&data[headerSize + i * crcSize], theCRCs[i], crcSize);
+    }
+
+    int file = ::open(aName, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0666);
+    FileGuard guard(file);
+
+    for (size_t done = 0; file >= 0 && done < data.size();)
+    {
+        ssize_t written = ::write(file, &data[done], static_cast<unsigned int>(data.size() - done));
+
+        if (written < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        done += written > 0 ? static_cast<size_t>(written) : 0;
+
+        if (done == data.size())
+        {
+            return true;
+        }
+    }
+
+    return fail(std::string("cannot write ") + aName + ": " + std::strerror(errno));
+}
+
+bool CRCBlockMap::verify(char const* aName, uint64_t anOffset, uint64_t aLength, std::vector<uint64_t>& someBlocks,
+                         unsigned int aNumThreads)
+{
+    someBlocks.clear();
+
+    if (anOffset >= theFileSize || aLength == 0)
+    {
+        return true;
+    }
+
+    int file = ::open(aName, O_RDONLY | O_BINARY);
+    FileGuard guard(file);
+
+    if (file < 0)
+    {
+        return fail(std::string("cannot open ") + aName + ": " + std::strerror(errno));
+    }
+
+    uint64_t first = anOffset / theBlockSize;
+    uint64_t count = numBlocks(anOffset, aLength);
+    std::vector<uint64_t> crcs(static_cast<size_t>(count));
+
+    if (!compute(file, first, count, crcs, aNumThreads))
+    {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (crcs[i] != theCRCs[first + i])
+        {
+            someBlocks.push_back(first + i);
+        }
+    }
+
+    return true;
+}
+
+bool CRCBlockMap::diff(CRCBlockMap const& anOther, std::vector<uint64_t>& someBlocks)
+{
+    someBlocks.clear();
+
+    if (theBlockSize != anOther.theBlockSize)
+    {
+        return fail("the maps have different block sizes");
+    }
+
+    size_t count = std::max(theCRCs.size(), anOther.theCRCs.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i >= theCRCs.size() || i >= anOther.theCRCs.size() || theCRCs[i] != anOther.theCRCs[i] ||
+            blockLength(i) != anOther.blockLength(i))
+        {
+            someBlocks.push_back(i);
+        }
+    }
+
+    return true;
+}
+
+void CRCBlockMap::addTo(ICRCAlgorithm& anAlgorithm) const
+{
+    for (size_t i = 0; i < theCRCs.size(); ++i)
+    {
+        anAlgorithm.addBlock(theCRCs[i], static_cast<size_t>(blockLength(i)));
+    }
+}
+
+uint64_t CRCBlockMap::blockSize() const
+{
+    return theBlockSize;
+}
+
+uint64_t CRCBlockMap::fileSize() const
+{
+    return theFileSize;
+}
+
+uint64_t CRCBlockMap::numBlocks() const
+{
+    return theCRCs.size();
+}
+
+uint64_t CRCBlockMap::numBlocks(uint64_t anOffset, uint64_t aLength) const
+{
+    if (anOffset >= theFileSize || aLength == 0)
+    {
+        return 0;
+    }
+
+    uint64_t end = aLength > theFileSize - anOffset ? theFileSize : anOffset + aLength;
+    return (end + theBlockSize - 1) / theBlockSize - anOffset / theBlockSize;
+}
+
+std::string const& CRCBlockMap::error() const
+{
+    return theError;
+}
+
+bool CRCBlockMap::isMap(char const* aName)
+{
+    int file = ::open(aName, O_RDONLY | O_BINARY);
+    FileGuard guard(file);
+    uint8_t header[sizeof(magic)];
+
+    return file >= 0 && readAt(file, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+           std::memcmp(header, magic, sizeof(magic)) == 0;
+}
+
+bool CRCBlockMap::compute(int aFile, uint64_t aFirst, uint64_t aCount, std::vector<uint64_t>& someCRCs, unsigned int aNumThreads)
+{
+    if (aNumThreads == 0)
+    {
+        aNumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // Blocks are handed out to the threads in order, so the file is read roughly sequentially
+    std::atomic<uint64_t> next(0);
+    std::atomic<bool> failed(false);
+    std::mutex merge;
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < aNumThreads && t < aCount; ++t)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            std::vector<uint8_t> buffer(static_cast<size_t>(theBlockSize));
+            uint64_t i;
+
+            while (!failed && (i = next.fetch_add(1)) < aCount)
+            {
+                uint64_t length = blockLength(aFirst + i);
+                ssize_t got = readAt(aFile, &buffer[0], static_cast<size_t>(length), (aFirst + i) * theBlockSize);
+
+                if (got != static_cast<ssize_t>(length))
+                {
+                    std::lock_guard<std::mutex> lock(merge);
+                    failed = true;
+                    fail(std::string("cannot read block ") + std::to_string(aFirst + i) + ": " +
+                         (got < 0 ? std::strerror(errno) : "file is shorter than the map"));
+                    break;
+                }
+
+                someCRCs[static_cast<size_t>(i)] = theAlgorithm.blockCRC(&buffer[0], static_cast<size_t>(length));
+            }
+        }));
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+
+    return !failed;
+}
+
+uint64_t CRCBlockMap::blockLength(uint64_t aBlock) const
+{
+    uint64_t offset = aBlock * theBlockSize;
+    return offset >= theFileSize ? 0 : std::min(theBlockSize, theFileSize - offset);
+}
+
+bool CRCBlockMap::fail(std::string const& aMessage)
+{
+    theError = aMessage;
+    return false;
+}
@@ -0,0 +1,147 @@
+#pragma once
+/*
+ * CRCBlockMap.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Forward
+class ICRCAlgorithm;
+
+/**
+ * The CRCs of the fixed size blocks of a file
+ * @ingroup Util
+ *
+ * Each block CRC is the register after adding the block to a zero register (see ICRCAlgorithm::blockCRC()),
+ * so the blocks are independent of each other and are computed in parallel. The CRC of the whole file,
+ * with any preset and inversion, is combined from the block CRCs without reading the file again.
+ *
+ * A map is saved as a sidecar file: a header with the block size, the file size and the polynomial,
+ * followed by the block CRCs, as many bytes each as the CRC has, in little endian byte order.
+ * Maps can be compared with each other, or with the current contents of a file, block by block.
+ */
+class CRCBlockMap
+{
+public:
+    /// Default block size: 4 MiB
+    static uint64_t const defaultBlockSize = 4 * 1024 * 1024;
+
+    /**
+     * Constructor
+     * @param anAlgorithm the algorithm for the block CRCs
+     * @param aGenerator the generator polynomial, which is saved with the map
+     * @param aWidth the number of bits in the CRC
+     * @param aNative whether the polynomial is in native order
+     */
+    CRCBlockMap(ICRCAlgorithm const& anAlgorithm, uint64_t aGenerator, unsigned int aWidth, bool aNative);
+
+    /**
+     * Compute the CRCs of all blocks of a file
+     * @param aName the name of the file. Block devices are supported.
+     * @param aBlockSize the block size in bytes
+     * @param aNumThreads the number of threads to use, 0 for one per core
+     * @return false on an error, see error()
+     */
+    bool build(char const* aName, uint64_t aBlockSize, unsigned int aNumThreads = 0);
+
+    /**
+     * Read a map from a sidecar file
+     * @param aName the name of the sidecar file
+     * @return false on an error or if the map was built with another polynomial, see error()
+     */
+    bool load(char const* aName);
+
+    /**
+     * Write the map to a sidecar file
+     * @param aName the name of the sidecar file
+     * @return false on an error, see error()
+     */
+    bool save(char const* aName);
+
+    /**
+     * Compare the blocks of a file which overlap a range of bytes with the map.
+     * Only these blocks are read, each of them completely.
+     * @param aName the name of the file
+     * @param anOffset the first byte of the range
+     * @param aLength the number of bytes in the range, which is cut off at the end of the map
+     * @param someBlocks receives the numbers of the blocks which differ
+     * @param aNumThreads the number of threads to use, 0 for one per core
+     * @return false on an error, see error()
+     */
+    bool verify(char const* aName, uint64_t anOffset, uint64_t aLength, std::vector<uint64_t>& someBlocks,
+                unsigned int aNumThreads = 0);
+
+    /**
+     * Compare two maps. Blocks beyond the end of one of them differ.
+     * @param anOther the other map
+     * @param someBlocks receives the numbers of the blocks which differ
+     * @return false if the maps have different block sizes, see error()
+     */
+    bool diff(CRCBlockMap const& anOther, std::vector<uint64_t>& someBlocks);
+
+    /**
+     * Add the whole file to a CRC calculation, by combining the block CRCs
+     * @param anAlgorithm the algorithm to add to
+     */
+    void addTo(ICRCAlgorithm& anAlgorithm) const;
+
+    /// @return the block size in bytes
+    uint64_t blockSize() const;
+
+    /// @return the size of the file in bytes
+    uint64_t fileSize() const;
+
+    /// @return the number of blocks
+    uint64_t numBlocks() const;
+
+    /**
+     * @param anOffset the first byte of a range
+     * @param aLength the number of bytes in the range, which is cut off at the end of the map
+     * @return the number of blocks which overlap the range, as compared by verify()
+     */
+    uint64_t numBlocks(uint64_t anOffset, uint64_t aLength) const;
+
+    /// @return the description of the last error, empty if none
+    std::string const& error() const;
+
+    /**
+     * @param aName the name of a file
+     * @return whether the file is a saved map
+     */
+    static bool isMap(char const* aName);
+
+private:
+    bool compute(int aFile, uint64_t aFirst, uint64_t aCount, std::vector<uint64_t>& someCRCs, unsigned int aNumThreads);
+    uint64_t blockLength(uint64_t aBlock) const;
+    bool fail(std::string const& aMessage);
+
+    ICRCAlgorithm const& theAlgorithm;
+    uint64_t theGenerator;
+    unsigned int theWidth;
+    bool isNative;
+    uint64_t theBlockSize;
+    uint64_t theFileSize;
+    std::vector<uint64_t> theCRCs;
+    std::string theError;
+};
@@ -0,0 +1,423 @@
+/*
+ * CRCFile.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#define _FILE_OFFSET_BITS 64    // Large files on 32 bit platforms
+
+#include "CRCFile.h"
+#include "ICRCAlgorithm.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined (WIN32)
+#  include <io.h>
+#  define lseek _lseeki64
+#  define ftruncate _chsize_s
+typedef int ssize_t;
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define O_BINARY 0
+#endif
+
+namespace
+{
+    size_t const bufferSize = 1024 * 1024;
+
+    // Size of the memory mapped windows when copying
+    int64_t const mapSize = 64 * 1024 * 1024;
+}
+
+CRCFile::CRCFile(char const* aName) :
+    theFile(-1),
+    isOwner(true),
+    theDestination(-1),
+    theBytesRead(0),
+    theBytesSkipped(0),
+    theBuffer(bufferSize)
+{
+    if (std::strcmp(aName, "-") == 0)
+    {
+        theFile = 0;
+        isOwner = false;
+#if defined (WIN32)
+        _setmode(theFile, O_BINARY);
+#endif
+    }
+    else
+    {
+        theFile = ::open(aName, O_RDONLY | O_BINARY);
+    }
+}
+
+CRCFile::~CRCFile()
+{
+    if (isOwner && theFile >= 0)
+    {
+        ::close(theFile);
+    }
+}
+
+bool CRCFile::isOpen() const
+{
+    return theFile >= 0;
+}
+
+uint64_t CRCFile::bytesRead() const
+{
+    return theBytesRead;
+}
+
+uint64_t CRCFile::bytesSkipped() const
+{
+    return theBytesSkipped;
+}
+
+bool CRCFile::addTo(ICRCAlgorithm& anAlgorithm)
+{
+    struct stat info;
+
+    if (::fstat(theFile, &info) != 0)
+    {
+        return false;
+    }
+
+    if (S_ISREG(info.st_mode))
+    {
+        return addSparse(anAlgorithm, info.st_size);
+    }
+
+    return addRest(anAlgorithm);
+}
+
+bool CRCFile::skip(uint64_t anOffset)
+{
+    struct stat info;
+
+    if (::fstat(theFile, &info) != 0)
+    {
+        return false;
+    }
+
+    if (S_ISREG(info.st_mode) && static_cast<uint64_t>(info.st_size) < anOffset)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    return ::lseek(theFile, static_cast<int64_t>(anOffset), SEEK_SET) == static_cast<int64_t>(anOffset);
+}
+
+bool CRCFile::copyTo(char const* aName, ICRCAlgorithm& anAlgorithm)
+{
+    bool toStdout = std::strcmp(aName, "-") == 0;
+    struct stat info;
+
+    if (::fstat(theFile, &info) != 0)
+    {
+        return false;
+    }
+
+    theDestination = toStdout ? 1 : ::open(aName, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0666);
+
+    if (theDestination < 0)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    bool regular = S_ISREG(info.st_mode);
+    struct stat destination;
+
+    if (regular && ::fstat(theDestination, &destination) == 0 && S_ISREG(destination.st_mode))
+    {
+        // Size the destination first, this leaves the holes in place.
+        ok = ::ftruncate(theDestination, info.st_size) == 0 && addSparse(anAlgorithm, info.st_size);
+    }
+    else
+    {
+        // Stream copy. The destination has to be written sequentially, so holes are read as well.
+        int64_t pos = regular ? ::lseek(theFile, 0, SEEK_CUR) : -1;
+        ok = pos >= 0 ? addRange(anAlgorithm, pos, info.st_size - pos) && addRest(anAlgorithm)
+             : addRest(anAlgorithm);
+    }
+
+    int error = errno;
+
+    if (!toStdout && ::close(theDestination) != 0)
+    {
+        ok = false;
+    }
+    else
+    {
+        errno = error;
+    }
+
+    theDestination = -1;
+    return ok;
+}
+
+bool CRCFile::addSparse(ICRCAlgorithm& anAlgorithm, int64_t aSize)
+{
+    int64_t pos = ::lseek(theFile, 0, SEEK_CUR);
+
+    if (pos < 0)
+    {
+        return addRest(anAlgorithm);
+    }
+
+    while (pos < aSize)
+    {
+        int64_t hole = aSize;
+
+#if defined (SEEK_DATA) && defined (SEEK_HOLE)
+        int64_t data = ::lseek(theFile, pos, SEEK_DATA);
+
+        if (data < 0)
+        {
+            // ENXIO: no more data, the rest of the file is a hole.
+            // Otherwise, holes are not supported here: it is all data.
+            data = errno == ENXIO ? aSize : pos;
+        }
+
+        addHole(anAlgorithm, data - pos);
+        pos = data;
+
+        if (pos >= aSize)
+        {
+            break;
+        }
+
+        hole = ::lseek(theFile, pos, SEEK_HOLE);
+
+        if (hole < 0 || hole > aSize)
+        {
+            hole = aSize;
+        }
+
+#endif
+
+        if (!addRange(anAlgorithm, pos, hole - pos))
+        {
+            return false;
+        }
+
+        pos = hole;
+    }
+
+    if (::lseek(theFile, pos, SEEK_SET) != pos)
+    {
+        return false;
+    }
+
+    // Whatever has not been covered yet, including data appended meanwhile
+    return addRest(anAlgorithm);
+}
+
+bool CRCFile::addRange(ICRCAlgorithm& anAlgorithm, int64_t anOffset, int64_t aLength)
+{
+    if (theDestination >= 0 && copyRange(anAlgorithm, anOffset, aLength))
+    {
+        return true;
+    }
+
+    if (::lseek(theFile, anOffset, SEEK_SET) != anOffset)
+    {
+        return false;
+    }
+
+    while (aLength > 0)
+    {
+        size_t chunk = aLength < static_cast<int64_t>(theBuffer.size()) ? static_cast<size_t>(aLength) : theBuffer.size();
+        ssize_t got = ::read(theFile, &theBuffer[0], chunk);
+
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (got == 0)
+        {
+            // File has been truncated meanwhile
+            break;
+        }
+
+        if (!addBuffer(anAlgorithm, static_cast<size_t>(got)))
+        {
+            return false;
+        }
+
+        aLength -= got;
+    }
+
+    return true;
+}
+
+bool CRCFile::copyRange(ICRCAlgorithm& anAlgorithm, int64_t anOffset, int64_t aLength)
+{
+#if defined (WIN32)
+    (void) anAlgorithm;
+    (void) anOffset;
+    (void) aLength;
+    return false;
+#else
+    int64_t const pageSize = ::sysconf(_SC_PAGESIZE);
+    int64_t done = 0;
+
+    while (done < aLength)
+    {
+        // Mappings must start at a page boundary
+        int64_t offset = anOffset + done;
+        int64_t start = offset - offset % pageSize;
+        int64_t length = aLength - done < mapSize ? aLength - done : mapSize;
+        size_t mapped = static_cast<size_t>(length + (offset - start));
+
+        void* src = ::mmap(0, mapped, PROT_READ, MAP_SHARED, theFile, start);
+
+        if (src == MAP_FAILED)
+        {
+            break;
+        }
+
+        void* dst = ::mmap(0, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, theDestination, start);
+
+        if (dst == MAP_FAILED)
+        {
+            ::munmap(src, mapped);
+            break;
+        }
+
+        ::madvise(src, mapped, MADV_SEQUENTIAL);
+        anAlgorithm.copyBytes(static_cast<uint8_t*>(dst) + (offset - start),
+                              static_cast<uint8_t const*>(src) + (offset - start),
+                              static_cast<size_t>(length));
+        ::munmap(dst, mapped);
+        ::munmap(src, mapped);
+
+        theBytesRead += static_cast<uint64_t>(length);
+        done += length;
+    }
+
+    if (done == aLength)
+    {
+        return true;
+    }
+
+    if (done == 0)
+    {
+        // Could not map anything: let the caller fall back to read/write
+        return false;
+    }
+
+    // Continue with read/write after a partial copy
+    return addRange(anAlgorithm, anOffset + done, aLength - done);
+#endif
+}
+
+bool CRCFile::addRest(ICRCAlgorithm& anAlgorithm)
+{
+    do
+    {
+        ssize_t got = ::read(theFile, &theBuffer[0], theBuffer.size());
+
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (got == 0)
+        {
+            return true;
+        }
+
+        if (!addBuffer(anAlgorithm, static_cast<size_t>(got)))
+        {
+            return false;
+        }
+    }
+    while (true);    // end by explicit return
+}
+
+bool CRCFile::addBuffer(ICRCAlgorithm& anAlgorithm, size_t aLength)
+{
+    anAlgorithm.addBytes(&theBuffer[0], aLength);
+    theBytesRead += aLength;
+
+    if (theDestination < 0)
+    {
+        return true;
+    }
+
+    // Copying without a memory mapping: write the buffer at the current position
+    int64_t pos = ::lseek(theFile, 0, SEEK_CUR) - static_cast<int64_t>(aLength);
+
+    if (pos >= 0)
+    {
+        ::lseek(theDestination, pos, SEEK_SET);
+    }
+
+    for (size_t done = 0; done < aLength; )
+    {
+        ssize_t written = ::write(theDestination, &theBuffer[done], aLength - done);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        done += static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+void CRCFile::addHole(ICRCAlgorithm& anAlgorithm, int64_t aLength)
+{
+    theBytesSkipped += static_cast<uint64_t>(aLength);
+
+    // size_t may be smaller than the hole
+    size_t const maxChunk = static_cast<size_t>(~0) >> 1;
+
+    while (aLength > 0)
+    {
+        size_t chunk = static_cast<uint64_t>(aLength) > maxChunk ? maxChunk : static_cast<size_t>(aLength);
+        anAlgorithm.addZeros(chunk);
+        aLength -= static_cast<int64_t>(chunk);
+    }
+}
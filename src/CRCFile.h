@@ -0,0 +1,99 @@
+#pragma once
+/*
+ * CRCFile.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Forward
+class ICRCAlgorithm;
+
+/**
+ * Feeds the contents of a file into a CRC algorithm
+ * @ingroup Util
+ *
+ * Regular files are scanned for holes with SEEK_DATA / SEEK_HOLE where the platform supports it.
+ * Holes are added to the CRC with ICRCAlgorithm::addZeros() instead of being read, so the time
+ * needed is proportional to the allocated data rather than to the apparent size of the file.
+ */
+class CRCFile
+{
+public:
+    /**
+     * Open a file for reading
+     * @param aName the name of the file, "-" for standard input
+     */
+    explicit CRCFile(char const* aName);
+    ~CRCFile();
+
+    /// @return whether the file could be opened
+    bool isOpen() const;
+
+    /**
+     * Add the contents of the file to the CRC calculation
+     * @param anAlgorithm the algorithm to feed
+     * @return false on a read error, errno tells why
+     */
+    bool addTo(ICRCAlgorithm& anAlgorithm);
+
+    /**
+     * Copy the file and add its contents to the CRC calculation in the same pass.
+     * Regular files are copied through memory mappings with ICRCAlgorithm::copyBytes(),
+     * so the data is touched only once. Holes are not written, so the copy is sparse as well.
+     * @param aName the name of the destination file, "-" for standard output
+     * @param anAlgorithm the algorithm to feed
+     * @return false on an error, errno tells why
+     */
+    bool copyTo(char const* aName, ICRCAlgorithm& anAlgorithm);
+
+    /**
+     * Skip the start of the file, so addTo() only adds the rest.
+     * @param anOffset the number of bytes to skip
+     * @return false if the file cannot seek or is shorter than anOffset, errno tells why
+     */
+    bool skip(uint64_t anOffset);
+
+    /// @return the number of bytes read (or copied) from the file
+    uint64_t bytesRead() const;
+
+    /// @return the number of bytes in holes, which have been added without reading them
+    uint64_t bytesSkipped() const;
+
+private:
+    CRCFile(CRCFile const&);
+    CRCFile& operator=(CRCFile const&);
+
+    bool addSparse(ICRCAlgorithm& anAlgorithm, int64_t aSize);
+    bool addRange(ICRCAlgorithm& anAlgorithm, int64_t anOffset, int64_t aLength);
+    bool copyRange(ICRCAlgorithm& anAlgorithm, int64_t anOffset, int64_t aLength);
+    bool addRest(ICRCAlgorithm& anAlgorithm);
+    bool addBuffer(ICRCAlgorithm& anAlgorithm, size_t aLength);
+    void addHole(ICRCAlgorithm& anAlgorithm, int64_t aLength);
+
+    int theFile;
+    bool isOwner;
+    int theDestination;
+    uint64_t theBytesRead;
+    uint64_t theBytesSkipped;
+    std::vector<uint8_t> theBuffer;
+};
@@ -23,6 +23,8 @@
  */
 
 #include "ICRCInfo.h"
+#include "crcpoly.h"
+#include "crctune.h"
 
 namespace CrcPP
 {
@@ -85,6 +87,24 @@ public:
         s << " + 1";
     }
 
+    void writeFactors(std::ostream& s) const
+    {
+        CrcPP::GF2Poly g = CrcPP::GF2Poly::generator(_algorithm.generator());
+        std::vector<CrcPP::GF2Poly::Factor> factors = g.factor();
+
+        s << std::dec;
+        CrcPP::GF2Poly::write(s, factors);
+
+        if (g.isPrimitive())
+        {
+            s << ", primitive";
+        }
+        else if (factors.size() == 1 && factors[0].multiplicity == 1)
+        {
+            s << ", irreducible";
+        }
+    }
+
     void writeTable(std::ostream& s) const
     {
         unsigned int fieldWidth = sizeof(typename P::data_type) * 2;
@@ -124,6 +144,59 @@ public:
         s << "};" << std::endl;
         s << std::dec;
     }
+
+    void tune(std::ostream& s) const
+    {
+        static char const* const sizes[CrcPP::numSizeClasses] =
+            { "below 16 bytes", "below 64 bytes", "below 256 bytes", "below 1K bytes", "below 4K bytes", "4K bytes and more" };
+
+        CrcPP::KernelTuner& tuner = CrcPP::KernelTuner::shared();
+        tuner.forget(_algorithm.generator());
+        CrcPP::CRC<P> crc = tuner.create(_algorithm.generator());
+        CrcPP::KernelTuner::Tuning tuning;
+
+        if (!tuner.find(_algorithm.generator(), crc.tables(), tuning))
+        {
+            s << "Not tuned: CRCPP_KERNEL selects the kernel" << std::endl;
+            return;
+        }
+
+        s << std::dec << "Tables: " << CrcPP::KernelTuner::tablesName(crc.tables()) << std::endl;
+
+        for (size_t i = 0; i < CrcPP::numSizeClasses; ++i)
+        {
+            s << std::left << std::setw(20) << sizes[i] << std::setw(10) << CrcPP::kernelName(tuning.choices[i].kernel)
+              << std::right << std::setw(8) << static_cast<unsigned long>(tuning.choices[i].speed + 0.5) << " MB/s" << std::endl;
+        }
+
+        if (tuner.path().empty())
+        {
+            s << "Not saved: no cache directory" << std::endl;
+            return;
+        }
+
+        s << "Saved to " << tuner.path() << std::endl;
+        char const* file = std::getenv("CRCPP_TUNING");
+
+        if (file == 0 || *file == 0)
+        {
+            s << "Set CRCPP_TUNING=" << tuner.path() << " to use it" << std::endl;
+        }
+    }
+
+    void getSyndromes(uint64_t* someSyndromes, size_t aCount) const
+    {
+        // Unused bits of the data type may contain garbage if numbits is not the full size
+        uint64_t mask = P::numbits < 64 ? (static_cast<uint64_t>(1) << P::numbits) - 1 : ~static_cast<uint64_t>(0);
+        P reg = 0;
+        _algorithm.addbit(1, reg);
+
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            someSyndromes[i] = static_cast<uint64_t>(static_cast<typename P::data_type>(reg)) & mask;
+            _algorithm.addbit(0, reg);
+        }
+    }
 private:
     CrcPP::CRC<P> const& _algorithm;
 };
@@ -0,0 +1,322 @@
+/*
+ * HexCodec.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "HexCodec.h"
+
+#include "crc.h"    // SIMD support and CPU features
+
+#include <cstring>
+#include <ostream>
+
+namespace
+{
+    size_t const bufferSize = 64 * 1024;
+
+    signed char const invalid = -1;
+    signed char const blank = -2;
+
+    // Value of each character as hex digit
+    class DigitTable
+    {
+    public:
+        DigitTable()
+        {
+            for (int c = 0; c < 256; ++c)
+            {
+                value[c] = invalid;
+            }
+
+            for (int c = '0'; c <= '9'; ++c)
+            {
+                value[c] = static_cast<signed char>(c - '0');
+            }
+
+            for (int c = 'a'; c <= 'f'; ++c)
+            {
+                value[c] = static_cast<signed char>(c - 'a' + 10);
+                value[c - 'a' + 'A'] = static_cast<signed char>(c - 'a' + 10);
+            }
+
+            value[static_cast<unsigned char>(' ')] = blank;
+            value[static_cast<unsigned char>('\t')] = blank;
+        }
+
+        signed char value[256];
+    };
+
+    DigitTable const digits;
+
+    char const hexDigits[] = "0123456789abcdef";
+
+#if defined (CRCPP_HAVE_SSE2)
+
+    // Positions of digits and blanks in the 15 characters "xx xx xx xx xx " and "xxxx xxxx xxxx "
+    int const pairsDigits = 0x36DB;
+    int const pairsBlanks = 0x4924;
+    int const groupsDigits = 0x3DEF;
+    int const groupsBlanks = 0x4210;
+
+    // Values of 16 characters as hex digits, with masks of the positions holding digits and blanks
+    __m128i classify(char const* aText, int& aDigitMask, int& aBlankMask)
+    {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(aText));
+        __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+        aDigitMask = _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter));
+        aBlankMask = _mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')));
+
+        return _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                            _mm_and_si128(isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    }
+
+    // Combine the digit values in each 16 bit lane into a byte, giving 8 bytes in the low half
+    __m128i pack(__m128i someValues)
+    {
+        __m128i high = _mm_slli_epi16(_mm_and_si128(someValues, _mm_set1_epi16(0x00FF)), 4);
+        return _mm_packus_epi16(_mm_or_si128(high, _mm_srli_epi16(someValues, 8)), _mm_setzero_si128());
+    }
+
+#  if defined (CRCPP_HAVE_X86_KERNELS)
+
+    // Move the digits of separated pairs or groups next to each other
+    CRCPP_TARGET("ssse3")
+    __m128i gather(__m128i someValues, bool isPairs)
+    {
+        __m128i index = isPairs ? _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, -1, -1, -1, -1, -1, -1)
+                                : _mm_setr_epi8(0, 1, 2, 3, 5, 6, 7, 8, 10, 11, 12, 13, -1, -1, -1, -1);
+        return _mm_shuffle_epi8(someValues, index);
+    }
+
+#  endif
+
+    // Decode a block of 16 characters if it has one of the known layouts
+    size_t decodeBlock(char const* aText, uint8_t* someBytes, size_t& aCount)
+    {
+        int digitMask;
+        int blankMask;
+        __m128i values = classify(aText, digitMask, blankMask);
+
+        if (digitMask == 0xFFFF)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(someBytes), pack(values));
+            aCount = 8;
+            return 16;
+        }
+
+#  if defined (CRCPP_HAVE_X86_KERNELS)
+
+        static bool const haveSSSE3 = CrcPP::CPUFeatures::get().ssse3;
+        bool isPairs = (digitMask & 0x7FFF) == pairsDigits && (blankMask & pairsBlanks) == pairsBlanks;
+        bool isGroups = (digitMask & 0x7FFF) == groupsDigits && (blankMask & groupsBlanks) == groupsBlanks;
+
+        if (haveSSSE3 && (isPairs || isGroups))
+        {
+            uint8_t bytes[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), pack(gather(values, isPairs)));
+            aCount = isPairs ? 5 : 6;
+            std::memcpy(someBytes, bytes, aCount);
+            return 15;
+        }
+
+#  endif
+
+        aCount = 0;
+        return 0;
+    }
+
+#endif
+}
+
+size_t HexCodec::decode(char const* aText, size_t aLength, uint8_t* someBytes, size_t& aCount)
+{
+    size_t pos = 0;
+    size_t count = 0;
+    int high = -1;      // first digit of the current byte, if any
+
+    while (pos < aLength)
+    {
+#if defined (CRCPP_HAVE_SSE2)
+
+        if (high < 0 && aLength - pos >= 16)
+        {
+            size_t produced;
+            size_t consumed = decodeBlock(aText + pos, someBytes + count, produced);
+
+            if (consumed > 0)
+            {
+                pos += consumed;
+                count += produced;
+                continue;
+            }
+        }
+
+#endif
+
+        signed char value = digits.value[static_cast<unsigned char>(aText[pos])];
+
+        if (value == blank && high < 0)
+        {
+            ++pos;
+            continue;
+        }
+
+        if (value < 0)
+        {
+            break;
+        }
+
+        if (high < 0)
+        {
+            high = value;
+        }
+        else
+        {
+            someBytes[count++] = static_cast<uint8_t>((high << 4) | value);
+            high = -1;
+        }
+
+        ++pos;
+    }
+
+    aCount = count;
+
+    // A single digit at the end is not a byte
+    return (pos == aLength && high >= 0) ? pos - 1 : pos;
+}
+
+void HexCodec::encode(uint8_t const* someBytes, size_t aCount, char* aText)
+{
+#if defined (CRCPP_HAVE_SSE2)
+
+    for (; aCount >= 16; aCount -= 16, someBytes += 16, aText += 32)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(someBytes));
+        __m128i mask = _mm_set1_epi8(0x0F);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+        __m128i low = _mm_and_si128(bytes, mask);
+
+        // '0' + n, plus the distance from '9' + 1 to 'a' for n > 9
+        __m128i letters = _mm_set1_epi8('a' - '0' - 10);
+        high = _mm_add_epi8(_mm_add_epi8(high, _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8(high, _mm_set1_epi8(9)), letters));
+        low = _mm_add_epi8(_mm_add_epi8(low, _mm_set1_epi8('0')), _mm_and_si128(_mm_cmpgt_epi8(low, _mm_set1_epi8(9)), letters));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aText), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aText + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+#endif
+
+    for (; aCount > 0; --aCount, ++someBytes)
+    {
+        *aText++ = hexDigits[*someBytes >> 4];
+        *aText++ = hexDigits[*someBytes & 0x0F];
+    }
+}
+
+HexWriter::HexWriter(std::ostream& aStream) :
+    theStream(aStream),
+    theBuffer(bufferSize),
+    theFill(0)
+{
+}
+
+HexWriter::~HexWriter()
+{
+    flush();
+}
+
+HexWriter& HexWriter::hex(uint8_t const* someBytes, size_t aCount)
+{
+    // Same layout as a hex dump of the command line tool: " xx" for each byte, grouped by 8 and 16
+    char digits[32];
+    char line[16 * 3 + 2];
+
+    for (size_t i = 0; i < aCount; i += 16)
+    {
+        size_t n = aCount - i < 16 ? aCount - i : 16;
+        size_t len = 0;
+        HexCodec::encode(someBytes + i, n, digits);
+
+        if (i > 0)
+        {
+            line[len++] = '\n';
+        }
+
+        for (size_t j = 0; j < n; ++j)
+        {
+            if (j == 8)
+            {
+                line[len++] = '\t';
+            }
+
+            line[len++] = ' ';
+            line[len++] = digits[2 * j];
+            line[len++] = digits[2 * j + 1];
+        }
+
+        put(line, len);
+    }
+
+    return *this;
+}
+
+HexWriter& HexWriter::raw(uint8_t const* someBytes, size_t aCount)
+{
+    put(reinterpret_cast<char const*>(someBytes), aCount);
+    return *this;
+}
+
+HexWriter& HexWriter::text(char const* aText)
+{
+    put(aText, std::strlen(aText));
+    return *this;
+}
+
+void HexWriter::flush()
+{
+    if (theFill > 0)
+    {
+        theStream.write(&theBuffer[0], static_cast<std::streamsize>(theFill));
+        theFill = 0;
+    }
+
+    theStream.flush();
+}
+
+void HexWriter::put(char const* someChars, size_t aCount)
+{
+    if (theFill + aCount > theBuffer.size())
+    {
+        flush();
+
+        if (aCount > theBuffer.size())
+        {
+            theStream.write(someChars, static_cast<std::streamsize>(aCount));
+            return;
+        }
+    }
+
+    std::memcpy(&theBuffer[theFill], someChars, aCount);
+    theFill += aCount;
+}
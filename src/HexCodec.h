@@ -0,0 +1,105 @@
+#pragma once
+/*
+ * HexCodec.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iosfwd>
+#include <vector>
+
+/**
+ * Conversion between bytes and hex digits
+ * @ingroup Util
+ *
+ * Blocks of 16 characters are decoded with SSE2 if they are contiguous hex digits, and with SSSE3
+ * if they are pairs of digits separated by blanks ("31 32 33") or groups of four digits ("3132 3334"),
+ * as written by od and xxd. Everything else is decoded one character at a time.
+ */
+class HexCodec
+{
+public:
+    /**
+     * Decode hex digits. Blanks and tabs between bytes are skipped. The two digits of a byte must be adjacent.
+     * @param aText the text to decode
+     * @param aLength the length of the text
+     * @param someBytes receives the bytes. Must have room for aLength / 2 bytes.
+     * @param aCount receives the number of bytes decoded
+     * @return aLength on success, or the position of the first character which is not valid
+     */
+    static size_t decode(char const* aText, size_t aLength, uint8_t* someBytes, size_t& aCount);
+
+    /**
+     * Encode bytes as two lower case hex digits each, without separators
+     * @param someBytes the bytes to encode
+     * @param aCount the number of bytes
+     * @param aText receives 2 * aCount characters
+     */
+    static void encode(uint8_t const* someBytes, size_t aCount, char* aText);
+};
+
+/**
+ * Buffered output of hex dumps and text to a stream
+ * @ingroup Util
+ *
+ * Output is collected in a buffer and written to the stream in large blocks,
+ * when the buffer is full, on flush() and on destruction.
+ */
+class HexWriter
+{
+public:
+    /**
+     * Constructor
+     * @param aStream the stream to write to
+     */
+    explicit HexWriter(std::ostream& aStream);
+    ~HexWriter();
+
+    /**
+     * Write bytes as hex: each byte preceded by a blank, a tab after 8 and a new line after 16 bytes
+     * @param someBytes the bytes to write
+     * @param aCount the number of bytes
+     */
+    HexWriter& hex(uint8_t const* someBytes, size_t aCount);
+
+    /**
+     * Write bytes as they are
+     * @param someBytes the bytes to write
+     * @param aCount the number of bytes
+     */
+    HexWriter& raw(uint8_t const* someBytes, size_t aCount);
+
+    /**
+     * Write text
+     * @param aText a null terminated string
+     */
+    HexWriter& text(char const* aText);
+
+    /// Write the buffer to the stream
+    void flush();
+
+private:
+    void put(char const* someChars, size_t aCount);
+
+    std::ostream& theStream;
+    std::vector<char> theBuffer;
+    size_t theFill;
+};
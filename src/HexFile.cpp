@@ -0,0 +1,392 @@
+/*
+ * HexFile.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "HexFile.h"
+#include "HexCodec.h"
+#include "ICRCAlgorithm.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+
+#if defined (WIN32)
+#  include <io.h>
+typedef int ssize_t;
+#else
+#  include <unistd.h>
+#  define O_BINARY 0
+#endif
+
+namespace
+{
+    size_t const bufferSize = 1024 * 1024;
+
+    // Data is passed to the algorithm in chunks of this size
+    size_t const chunkSize = 64 * 1024;
+
+    bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    bool isHexDigit(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    // Length of the first token of a line
+    size_t tokenLength(char const* aLine, size_t aLength)
+    {
+        size_t len = 0;
+
+        while (len < aLength && !isBlank(aLine[len]))
+        {
+            ++len;
+        }
+
+        return len;
+    }
+}
+
+HexFile::HexFile(char const* aName) :
+    theFile(-1),
+    isOwner(true),
+    theBuffer(bufferSize),
+    theStart(0),
+    theEnd(0),
+    isEof(false),
+    theLayout(LayoutUnknown),
+    theLine(0),
+    theBytes(0),
+    theOffset(0),
+    isRepeat(false)
+{
+    if (std::strcmp(aName, "-") == 0)
+    {
+        theFile = 0;
+        isOwner = false;
+#if defined (WIN32)
+        _setmode(theFile, O_BINARY);
+#endif
+    }
+    else
+    {
+        theFile = ::open(aName, O_RDONLY | O_BINARY);
+    }
+}
+
+HexFile::~HexFile()
+{
+    if (isOwner && theFile >= 0)
+    {
+        ::close(theFile);
+    }
+}
+
+bool HexFile::isOpen() const
+{
+    return theFile >= 0;
+}
+
+bool HexFile::addTo(ICRCAlgorithm& anAlgorithm)
+{
+    std::vector<uint8_t> chunk;
+    char const* line;
+    size_t len;
+
+    while (nextLine(line, len))
+    {
+        if (!decodeLine(line, len, chunk))
+        {
+            return false;
+        }
+
+        if (chunk.size() >= chunkSize)
+        {
+            anAlgorithm.addBytes(&chunk[0], chunk.size());
+            chunk.clear();
+        }
+    }
+
+    if (!chunk.empty())
+    {
+        anAlgorithm.addBytes(&chunk[0], chunk.size());
+    }
+
+    return theError.empty();
+}
+
+bool HexFile::nextFrame(std::vector<uint8_t>& aFrame)
+{
+    char const* line;
+    size_t len;
+    aFrame.clear();
+
+    while (nextLine(line, len))
+    {
+        if (len == 0)
+        {
+            // An empty line ends a dump, empty lines between frames are skipped
+            if (!aFrame.empty())
+            {
+                break;
+            }
+
+            theOffset = 0;
+            continue;
+        }
+
+        if (!decodeLine(line, len, aFrame))
+        {
+            return false;
+        }
+
+        if (theLayout == LayoutPlain && !aFrame.empty())
+        {
+            return true;
+        }
+    }
+
+    return !aFrame.empty() && theError.empty();
+}
+
+std::string const& HexFile::error() const
+{
+    return theError;
+}
+
+uint64_t HexFile::bytesDecoded() const
+{
+    return theBytes;
+}
+
+bool HexFile::nextLine(char const*& aLine, size_t& aLength)
+{
+    while (theError.empty())
+    {
+        char* start = &theBuffer[0] + theStart;
+        char* end = static_cast<char*>(std::memchr(start, '\n', theEnd - theStart));
+
+        if (end != 0 || (isEof && theStart < theEnd))
+        {
+            if (end == 0)
+            {
+                end = &theBuffer[0] + theEnd;   // last line without line end
+            }
+
+            theStart = end - &theBuffer[0] + (end < &theBuffer[0] + theEnd ? 1 : 0);
+            ++theLine;
+
+            // Text files from DOS
+            if (end > start && end[-1] == '\r')
+            {
+                --end;
+            }
+
+            aLine = start;
+            aLength = end - start;
+            return true;
+        }
+
+        if (isEof)
+        {
+            return false;
+        }
+
+        // Move the incomplete line to the front, and make room for at least a buffer full
+        std::memmove(&theBuffer[0], start, theEnd - theStart);
+        theEnd -= theStart;
+        theStart = 0;
+
+        if (theBuffer.size() - theEnd < bufferSize / 2)
+        {
+            theBuffer.resize(theBuffer.size() + bufferSize);
+        }
+
+        ssize_t n = ::read(theFile, &theBuffer[theEnd], static_cast<unsigned int>(theBuffer.size() - theEnd));
+
+        if (n < 0)
+        {
+            if (errno != EINTR)
+            {
+                fail(std::strerror(errno));
+            }
+        }
+        else if (n == 0)
+        {
+            isEof = true;
+        }
+        else
+        {
+            theEnd += static_cast<size_t>(n);
+        }
+    }
+
+    return false;
+}
+
+bool HexFile::decodeLine(char const* aLine, size_t aLength, std::vector<uint8_t>& someBytes)
+{
+    if (theLayout == LayoutUnknown)
+    {
+        detectLayout(aLine, aLength);
+
+        if (theLayout == LayoutUnknown)
+        {
+            return true;    // nothing but blanks
+        }
+    }
+
+    size_t begin = 0;
+    size_t end = aLength;
+
+    if (theLayout != LayoutPlain && aLength > 0)
+    {
+        size_t token = tokenLength(aLine, aLength);
+
+        if (token == 1 && aLine[0] == '*')
+        {
+            isRepeat = true;
+            return true;
+        }
+
+        // The offset ends with a colon in xxd dumps
+        std::string offsetText(aLine, theLayout == LayoutXxd && token > 0 ? token - 1 : token);
+        char* offsetEnd;
+        uint64_t offset = std::strtoull(offsetText.c_str(), &offsetEnd, 16);
+
+        if (offsetText.empty() || *offsetEnd != 0)
+        {
+            fail("invalid offset");
+            return false;
+        }
+
+        if (isRepeat)
+        {
+            // Repeat the previous line up to this offset
+            if (thePrevious.empty() || offset < theOffset || (offset - theOffset) % thePrevious.size() != 0)
+            {
+                fail("repeated line does not fit the offset");
+                return false;
+            }
+
+            for (; theOffset < offset; theOffset += thePrevious.size())
+            {
+                someBytes.insert(someBytes.end(), thePrevious.begin(), thePrevious.end());
+                theBytes += thePrevious.size();
+            }
+
+            isRepeat = false;
+        }
+
+        // The characters follow the bytes after two blanks in xxd dumps, and between | or > in others
+        begin = token;
+
+        for (end = begin; end < aLength; ++end)
+        {
+            if (theLayout == LayoutXxd ? (end + 1 < aLength && aLine[end] == ' ' && aLine[end + 1] == ' ' && end > begin + 1)
+                                       : (aLine[end] == '|' || aLine[end] == '>'))
+            {
+                break;
+            }
+        }
+
+        theOffset = offset;
+    }
+
+    size_t oldSize = someBytes.size();
+    size_t count;
+    someBytes.resize(oldSize + (end - begin) / 2 + 1);
+    size_t pos = HexCodec::decode(aLine + begin, end - begin, &someBytes[oldSize], count);
+    someBytes.resize(oldSize + count);
+    theBytes += count;
+
+    if (pos != end - begin)
+    {
+        fail("invalid hex data in column " + std::to_string(begin + pos + 1));
+        return false;
+    }
+
+    if (theLayout != LayoutPlain)
+    {
+        thePrevious.assign(someBytes.begin() + oldSize, someBytes.end());
+        theOffset += count;
+    }
+
+    return true;
+}
+
+void HexFile::detectLayout(char const* aLine, size_t aLength)
+{
+    size_t token = tokenLength(aLine, aLength);
+
+    if (token == 0)
+    {
+        // Dumps start with an offset, hex data may start with a blank
+        while (token < aLength && isBlank(aLine[token]))
+        {
+            ++token;
+        }
+
+        if (token < aLength)
+        {
+            theLayout = LayoutPlain;
+        }
+
+        return;     // otherwise, decide on the next line which is not empty
+    }
+
+    if (aLine[token - 1] == ':')
+    {
+        theLayout = LayoutXxd;
+        return;
+    }
+
+    // An offset of at least 4 digits followed by single bytes
+    size_t next = token;
+
+    while (next < aLength && isBlank(aLine[next]))
+    {
+        ++next;
+    }
+
+    bool isOffset = token >= 4 && tokenLength(aLine + next, aLength - next) == 2;
+
+    for (size_t i = 0; isOffset && i < token; ++i)
+    {
+        isOffset = isHexDigit(aLine[i]);
+    }
+
+    theLayout = isOffset ? LayoutOffset : LayoutPlain;
+}
+
+void HexFile::fail(std::string const& aMessage)
+{
+    if (theError.empty())
+    {
+        std::ostringstream s;
+        s << "line " << theLine << ": " << aMessage;
+        theError = s.str();
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+/*
+ * HexFile.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Forward
+class ICRCAlgorithm;
+
+/**
+ * Reads hex data from a text file
+ * @ingroup Util
+ *
+ * The layout is recognized from the first line which is not empty:
+ * - plain: hex digits, optionally with blanks between bytes ("313233" or "31 32 33")
+ * - xxd: an offset followed by a colon, groups of digits and the characters ("00000000: 3132 3334  1234")
+ * - od -A x -t x1z and hexdump -C: an offset, bytes and the characters ("00000000  31 32 33 34  |1234|")
+ *
+ * In dumps, a line "*" repeats the previous line up to the offset of the next line.
+ * Frames are separated by line ends in plain files, and by empty lines in dumps.
+ */
+class HexFile
+{
+public:
+    /**
+     * Open a file for reading
+     * @param aName the name of the file, "-" for standard input
+     */
+    explicit HexFile(char const* aName);
+    ~HexFile();
+
+    /// @return whether the file could be opened
+    bool isOpen() const;
+
+    /**
+     * Add all data in the file to the CRC calculation
+     * @param anAlgorithm the algorithm to feed
+     * @return false on a read or syntax error, see error()
+     */
+    bool addTo(ICRCAlgorithm& anAlgorithm);
+
+    /**
+     * Read the next frame
+     * @param aFrame receives the data of the frame
+     * @return false at the end of the file, or on a read or syntax error, see error()
+     */
+    bool nextFrame(std::vector<uint8_t>& aFrame);
+
+    /// @return the description of the last error, empty if none
+    std::string const& error() const;
+
+    /// @return the number of bytes decoded so far
+    uint64_t bytesDecoded() const;
+
+private:
+    enum Layout
+    {
+        LayoutUnknown,
+        LayoutPlain,
+        LayoutXxd,
+        LayoutOffset
+    };
+
+    bool nextLine(char const*& aLine, size_t& aLength);
+    bool decodeLine(char const* aLine, size_t aLength, std::vector<uint8_t>& someBytes);
+    void detectLayout(char const* aLine, size_t aLength);
+    void fail(std::string const& aMessage);
+
+    int theFile;
+    bool isOwner;
+    std::vector<char> theBuffer;
+    size_t theStart;
+    size_t theEnd;
+    bool isEof;
+    Layout theLayout;
+    uint64_t theLine;
+    uint64_t theBytes;
+    std::string theError;
+    std::vector<uint8_t> thePrevious;   // data of the previous dump line
+    uint64_t theOffset;                 // offset after the previous dump line
+    bool isRepeat;                      // the previous dump line is repeated
+};
@@ -23,6 +23,7 @@
  */
 
 // ReSharper disable CppUnusedIncludeDirective
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 // ReSharper restore CppUnusedIncludeDirective
@@ -44,6 +45,28 @@ public:
      */
     virtual void addByte(uint8_t b) = 0;
 
+    /**
+     * Add a sequence of bytes to the CRC calculation
+     * @param data the bytes to add
+     * @param len the number of bytes
+     */
+    virtual void addBytes(uint8_t const* data, size_t len) = 0;
+
+    /**
+     * Copy a sequence of bytes and add it to the CRC calculation in the same pass
+     * @param dst the destination
+     * @param src the bytes to copy and add
+     * @param len the number of bytes
+     */
+    virtual void copyBytes(uint8_t* dst, uint8_t const* src, size_t len) = 0;
+
+    /**
+     * Add a sequence of zero bytes to the CRC calculation.
+     * The time needed is O(log n), so this is the way to add holes in sparse files.
+     * @param n the number of zero bytes
+     */
+    virtual void addZeros(size_t n) = 0;
+
     /**
      * Reset CRC calculation.
      * The crc value is reset to the preset value
@@ -59,4 +82,48 @@ public:
      * Gets the current result of CRC computation in a byte order suitable for adding to the output stream.
      */
     virtual ByteString result() const = 0;
+
+    /**
+     * Check the CRCs of independent frames, each ending with its CRC.
+     * Does not use or change the state of the calculation, so several threads may check frames at the same time.
+     * @param someFrames the frames
+     * @param someLengths the length of each frame, including the CRC
+     * @param someResults receives for each frame whether its CRC is good
+     * @param aCount the number of frames
+     */
+    virtual void checkFrames(uint8_t const* const* someFrames, size_t const* someLengths, bool* someResults, size_t aCount) const = 0;
+
+    /**
+     * Compute the CRC register of a block of data on its own, starting with a zero register, without preset and inversion.
+     * Does not use or change the state of the calculation, so several threads may compute blocks at the same time.
+     * @param data the block
+     * @param len the number of bytes
+     * @return the register value
+     */
+    virtual uint64_t blockCRC(uint8_t const* data, size_t len) const = 0;
+
+    /**
+     * Add a block of data to the CRC calculation which is only known by its blockCRC(). The time needed is O(log len).
+     * @param aBlockCRC the register value of the block, as returned by blockCRC()
+     * @param len the number of bytes in the block
+     */
+    virtual void addBlock(uint64_t aBlockCRC, size_t len) = 0;
+
+    /**
+     * @return the number of bytes added since the last reset
+     */
+    virtual uint64_t length() const = 0;
+
+    /**
+     * Export the state of the calculation, to continue it later with importState()
+     * @return the state: register, length and algorithm identity
+     */
+    virtual ByteString exportState() const = 0;
+
+    /**
+     * Continue a calculation from an exported state
+     * @param aState the state, as returned by exportState()
+     * @return false if the state is not a state of this algorithm, with the same preset and invert
+     */
+    virtual bool importState(ByteString const& aState) = 0;
 };
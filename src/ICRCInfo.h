@@ -22,6 +22,10 @@
  *  Created on: Apr 16, 2014
  */
 
+#include <stddef.h>
+#include <stdint.h>
+#include <iosfwd>
+
 /**
  * Abstract description for the parameters of a CRC algorithms
  * @ingroup Util
@@ -34,6 +38,27 @@ public:
     virtual unsigned int numBits() const = 0;
     virtual unsigned int numBytes() const = 0;
     virtual void writePoly(std::ostream& s) const = 0;
+
+    /**
+     * Write the irreducible factors of the generator polynomial, and whether it is primitive
+     * @param s the stream to write to
+     */
+    virtual void writeFactors(std::ostream& s) const = 0;
     virtual void writeTable(std::ostream& s) const = 0;
 
+    /**
+     * Measure the kernels and tables for the generator polynomial on this CPU, save the results
+     * to the tuning cache, and write them
+     * @param s the stream to write to
+     */
+    virtual void tune(std::ostream& s) const = 0;
+
+    /**
+     * Get the syndromes of single bit errors: X^i mod G, scaled by X^numBits(), for i = 0 ... aCount - 1.
+     * These are the register contents for a message with a single bit set, followed by i zero bits.
+     * @param someSyndromes receives the syndromes
+     * @param aCount the number of syndromes to compute
+     */
+    virtual void getSyndromes(uint64_t* someSyndromes, size_t aCount) const = 0;
+
 };
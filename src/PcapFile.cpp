@@ -0,0 +1,506 @@
+/*
+ * PcapFile.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "PcapFile.h"
+#include "ICRCAlgorithm.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+#if defined (WIN32)
+#  include <io.h>
+typedef int ssize_t;
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  define O_BINARY 0
+#endif
+
+namespace
+{
+    // Number of frames handed to a thread at a time
+    size_t const batchSize = 1024;
+
+    uint32_t const pcapMagic = 0xA1B2C3D4;
+    uint32_t const pcapNanoMagic = 0xA1B23C4D;
+    uint32_t const byteOrderMagic = 0x1A2B3C4D;
+
+    size_t const pcapHeaderSize = 24;
+    size_t const pcapRecordSize = 16;
+
+    // pcapng block types
+    uint32_t const sectionHeaderBlock = 0x0A0D0D0A;
+    uint32_t const interfaceBlock = 1;
+    uint32_t const packetBlock = 2;
+    uint32_t const simplePacketBlock = 3;
+    uint32_t const enhancedPacketBlock = 6;
+
+    // if_fcslen option of the interface description block
+    uint16_t const optionEnd = 0;
+    uint16_t const optionFCSLength = 13;
+
+    uint32_t const linkTypeEthernet = 1;
+
+    // Destination, source, type and FCS
+    size_t const minFrameSize = 18;
+    size_t const fcsSize = 4;
+
+    uint32_t swap32(uint32_t v)
+    {
+        return (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+    }
+
+    uint32_t native32(uint8_t const* p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    size_t padded(size_t aLength)
+    {
+        return (aLength + 3) & ~static_cast<size_t>(3);
+    }
+
+    bool byNumber(PcapFile::Frame const& a, PcapFile::Frame const& b)
+    {
+        return a.number < b.number;
+    }
+}
+
+PcapFile::PcapFile(char const* aName) :
+    theFile(-1),
+    theData(0),
+    theSize(0),
+    thePos(0),
+    isNg(false),
+    isSwapped(false),
+    theFrames(0),
+    theGood(0),
+    theSkipped(0),
+    theBytes(0)
+{
+    theFile = ::open(aName, O_RDONLY | O_BINARY);
+
+    if (theFile < 0)
+    {
+        return;
+    }
+
+    struct stat info;
+
+    if (::fstat(theFile, &info) != 0 || info.st_size < static_cast<off_t>(pcapHeaderSize))
+    {
+        errno = EINVAL;
+        return;
+    }
+
+    theSize = static_cast<size_t>(info.st_size);
+
+#if defined (WIN32)
+    // No memory mapping: read the file
+    theBuffer.resize(theSize);
+
+    for (size_t done = 0; done < theSize;)
+    {
+        ssize_t got = ::read(theFile, &theBuffer[done], static_cast<unsigned int>(std::min<size_t>(theSize - done, 1 << 30)));
+
+        if (got <= 0)
+        {
+            return;
+        }
+
+        done += static_cast<size_t>(got);
+    }
+
+    theData = &theBuffer[0];
+#else
+    void* mapped = ::mmap(0, theSize, PROT_READ, MAP_SHARED, theFile, 0);
+
+    if (mapped == MAP_FAILED)
+    {
+        return;
+    }
+
+    ::madvise(mapped, theSize, MADV_SEQUENTIAL);
+    theData = static_cast<uint8_t const*>(mapped);
+#endif
+
+    if (!readHeader())
+    {
+        errno = EINVAL;
+    }
+}
+
+PcapFile::~PcapFile()
+{
+#if !defined (WIN32)
+    if (theData != 0)
+    {
+        ::munmap(const_cast<uint8_t*>(theData), theSize);
+    }
+#endif
+
+    if (theFile >= 0)
+    {
+        ::close(theFile);
+    }
+}
+
+bool PcapFile::isOpen() const
+{
+    return theData != 0 && (isNg || thePos > 0);
+}
+
+bool PcapFile::check(ICRCAlgorithm const& anAlgorithm, unsigned int aNumThreads)
+{
+    if (aNumThreads == 0)
+    {
+        aNumThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    std::mutex parse;
+    std::mutex merge;
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < aNumThreads; ++t)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            std::vector<Frame> batch;
+            std::vector<uint8_t const*> data(batchSize);
+            std::vector<size_t> lengths(batchSize);
+            bool results[batchSize];
+            std::vector<Frame> bad;
+            uint64_t good = 0;
+            uint64_t bytes = 0;
+
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(parse);
+
+                    if (!next(batch, batchSize))
+                    {
+                        break;
+                    }
+                }
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    data[i] = batch[i].data;
+                    lengths[i] = batch[i].length;
+                    bytes += batch[i].length;
+                }
+
+                anAlgorithm.checkFrames(&data[0], &lengths[0], results, batch.size());
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    if (results[i])
+                    {
+                        ++good;
+                    }
+                    else
+                    {
+                        bad.push_back(batch[i]);
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(merge);
+            theGood += good;
+            theBytes += bytes;
+            theBad.insert(theBad.end(), bad.begin(), bad.end());
+        }));
+    }
+
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+
+    std::sort(theBad.begin(), theBad.end(), byNumber);
+    return theError.empty();
+}
+
+std::string const& PcapFile::error() const
+{
+    return theError;
+}
+
+uint64_t PcapFile::frames() const
+{
+    return theFrames;
+}
+
+uint64_t PcapFile::goodFrames() const
+{
+    return theGood;
+}
+
+uint64_t PcapFile::skippedFrames() const
+{
+    return theSkipped;
+}
+
+std::vector<PcapFile::Frame> const& PcapFile::badFrames() const
+{
+    return theBad;
+}
+
+uint64_t PcapFile::bytesChecked() const
+{
+    return theBytes;
+}
+
+bool PcapFile::readHeader()
+{
+    uint32_t magic = native32(theData);
+
+    if (magic == sectionHeaderBlock)
+    {
+        isNg = true;
+        return true;    // the first block sets the byte order
+    }
+
+    isSwapped = magic == swap32(pcapMagic) || magic == swap32(pcapNanoMagic);
+
+    if (!isSwapped && magic != pcapMagic && magic != pcapNanoMagic)
+    {
+        return false;
+    }
+
+    // The upper bits of the link type may hold the FCS length, in units of 16 bits
+    uint32_t linkType = get32(theData + 20);
+    Interface link = { linkType & 0xFFFF, (linkType & 0x04000000) == 0 || (linkType >> 28) * 2 == fcsSize };
+    theInterfaces.push_back(link);
+    thePos = pcapHeaderSize;
+    return true;
+}
+
+bool PcapFile::next(std::vector<Frame>& someFrames, size_t aMax)
+{
+    someFrames.clear();
+
+    while (someFrames.size() < aMax && thePos < theSize && theError.empty())
+    {
+        if (isNg)
+        {
+            if (!nextBlock(someFrames))
+            {
+                break;
+            }
+        }
+        else
+        {
+            if (theSize - thePos < pcapRecordSize)
+            {
+                fail("truncated record header");
+                break;
+            }
+
+            uint8_t const* record = theData + thePos;
+            size_t captured = get32(record + 8);
+            size_t original = get32(record + 12);
+
+            if (theSize - thePos - pcapRecordSize < captured)
+            {
+                fail("truncated frame");
+                break;
+            }
+
+            addFrame(someFrames, 0, record + pcapRecordSize, captured, original);
+            thePos += pcapRecordSize + captured;
+        }
+    }
+
+    return !someFrames.empty();
+}
+
+bool PcapFile::nextBlock(std::vector<Frame>& someFrames)
+{
+    if (theSize - thePos < 12)
+    {
+        fail("truncated block header");
+        return false;
+    }
+
+    uint8_t const* block = theData + thePos;
+    uint32_t type = native32(block);
+
+    if (type == sectionHeaderBlock)
+    {
+        // The byte order magic decides how to read the block length
+        uint32_t magic = native32(block + 8);
+
+        if (magic != byteOrderMagic && magic != swap32(byteOrderMagic))
+        {
+            fail("invalid section header");
+            return false;
+        }
+
+        isSwapped = magic != byteOrderMagic;
+    }
+
+    size_t length = get32(block + 4);
+
+    if (length < 12 || length % 4 != 0 || length > theSize - thePos)
+    {
+        fail("invalid or truncated block");
+        return false;
+    }
+
+    uint8_t const* body = block + 8;
+    size_t bodyLength = length - 12;
+
+    switch (get32(block))
+    {
+        case sectionHeaderBlock:
+            if (!readSection(body, bodyLength))
+            {
+                return false;
+            }
+
+            break;
+
+        case interfaceBlock:
+            readInterface(body, bodyLength);
+            break;
+
+        case enhancedPacketBlock:
+            if (bodyLength < 20 || padded(get32(body + 12)) > bodyLength - 20)
+            {
+                fail("invalid packet block");
+                return false;
+            }
+
+            addFrame(someFrames, get32(body), body + 20, get32(body + 12), get32(body + 16));
+            break;
+
+        case simplePacketBlock:
+            if (bodyLength < 4)
+            {
+                fail("invalid packet block");
+                return false;
+            }
+
+            // The captured length is only given by the block length
+            addFrame(someFrames, 0, body + 4, std::min<size_t>(get32(body), bodyLength - 4), get32(body));
+            break;
+
+        case packetBlock:
+            if (bodyLength < 20 || padded(get32(body + 12)) > bodyLength - 20)
+            {
+                fail("invalid packet block");
+                return false;
+            }
+
+            addFrame(someFrames, get16(body), body + 20, get32(body + 12), get32(body + 16));
+            break;
+
+        default:
+            break;  // statistics, name resolution, custom blocks ...
+    }
+
+    thePos += length;
+    return true;
+}
+
+bool PcapFile::readSection(uint8_t const* aBody, size_t aLength)
+{
+    if (aLength < 16 || get16(aBody + 4) != 1)
+    {
+        fail("unsupported pcapng version");
+        return false;
+    }
+
+    // Interface numbers start over in each section
+    theInterfaces.clear();
+    return true;
+}
+
+void PcapFile::readInterface(uint8_t const* aBody, size_t aLength)
+{
+    Interface link = { aLength >= 8 ? get16(aBody) : 0U, true };
+
+    for (size_t pos = 8; pos + 4 <= aLength;)
+    {
+        uint16_t code = get16(aBody + pos);
+        uint16_t length = get16(aBody + pos + 2);
+
+        if (code == optionEnd || pos + 4 + length > aLength)
+        {
+            break;
+        }
+
+        if (code == optionFCSLength && length >= 1)
+        {
+            link.hasFCS = aBody[pos + 4] == fcsSize;
+        }
+
+        pos += 4 + padded(length);
+    }
+
+    theInterfaces.push_back(link);
+}
+
+void PcapFile::addFrame(std::vector<Frame>& someFrames, uint32_t anInterface, uint8_t const* someData,
+                        size_t aCapturedLength, size_t anOriginalLength)
+{
+    Frame frame = { someData, aCapturedLength, ++theFrames };
+
+    if (anInterface >= theInterfaces.size() || theInterfaces[anInterface].linkType != linkTypeEthernet ||
+        !theInterfaces[anInterface].hasFCS || aCapturedLength < anOriginalLength || aCapturedLength < minFrameSize)
+    {
+        ++theSkipped;
+        return;
+    }
+
+    someFrames.push_back(frame);
+}
+
+uint16_t PcapFile::get16(uint8_t const* p) const
+{
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return isSwapped ? static_cast<uint16_t>((v >> 8) | (v << 8)) : v;
+}
+
+uint32_t PcapFile::get32(uint8_t const* p) const
+{
+    uint32_t v = native32(p);
+    return isSwapped ? swap32(v) : v;
+}
+
+void PcapFile::fail(std::string const& aMessage)
+{
+    std::ostringstream s;
+    s << "frame " << theFrames + 1 << " at offset " << thePos << ": " << aMessage;
+    theError = s.str();
+}
@@ -0,0 +1,128 @@
+#pragma once
+/*
+ * PcapFile.h
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Forward
+class ICRCAlgorithm;
+
+/**
+ * Checks the frame check sequence of the Ethernet frames in a capture file
+ * @ingroup Util
+ *
+ * Reads pcap files (either byte order, micro- or nanosecond timestamps) and pcapng files
+ * (enhanced, simple and obsolete packet blocks, any number of sections and interfaces) without libpcap.
+ * The file is mapped into memory, so the frames are checked where they are.
+ *
+ * The frames are parsed by one thread at a time, in batches. The CRCs of a batch are computed
+ * outside the lock with ICRCAlgorithm::checkFrames(), which adds several frames in parallel.
+ * Frames of other link types, frames truncated by the snap length, frames of interfaces
+ * which declare an FCS length other than 4 bytes, and runts shorter than header and FCS are skipped.
+ */
+class PcapFile
+{
+public:
+    /// A frame in the capture
+    struct Frame
+    {
+        uint8_t const* data;    ///< the captured data, ending with the FCS
+        size_t length;          ///< the captured length
+        uint64_t number;        ///< the number of the frame in the file, starting at 1
+    };
+
+    /**
+     * Open a capture file
+     * @param aName the name of the file
+     */
+    explicit PcapFile(char const* aName);
+    ~PcapFile();
+
+    /// @return whether the file could be opened and has a pcap or pcapng header
+    bool isOpen() const;
+
+    /**
+     * Check all frames
+     * @param anAlgorithm the FCS algorithm
+     * @param aNumThreads the number of threads to use, 0 for one per core
+     * @return false if the file is damaged, see error(). The frames up to the damage have been checked.
+     */
+    bool check(ICRCAlgorithm const& anAlgorithm, unsigned int aNumThreads = 0);
+
+    /// @return the description of the error, empty if none
+    std::string const& error() const;
+
+    /// @return the number of frames in the file
+    uint64_t frames() const;
+
+    /// @return the number of frames with a good FCS
+    uint64_t goodFrames() const;
+
+    /// @return the number of frames which have not been checked
+    uint64_t skippedFrames() const;
+
+    /// @return the frames with a bad FCS, by number
+    std::vector<Frame> const& badFrames() const;
+
+    /// @return the number of bytes in frames which have been checked
+    uint64_t bytesChecked() const;
+
+private:
+    PcapFile(PcapFile const&);
+    PcapFile& operator=(PcapFile const&);
+
+    /// Interface of a pcapng section, or the link of a pcap file
+    struct Interface
+    {
+        uint32_t linkType;
+        bool hasFCS;
+    };
+
+    bool readHeader();
+    bool next(std::vector<Frame>& someFrames, size_t aMax);
+    bool nextBlock(std::vector<Frame>& someFrames);
+    bool readSection(uint8_t const* aBody, size_t aLength);
+    void readInterface(uint8_t const* aBody, size_t aLength);
+    void addFrame(std::vector<Frame>& someFrames, uint32_t anInterface, uint8_t const* someData,
+                  size_t aCapturedLength, size_t anOriginalLength);
+    uint16_t get16(uint8_t const* p) const;
+    uint32_t get32(uint8_t const* p) const;
+    void fail(std::string const& aMessage);
+
+    int theFile;
+    uint8_t const* theData;
+    size_t theSize;
+    size_t thePos;
+    std::vector<uint8_t> theBuffer;     // the file contents where it cannot be mapped
+    bool isNg;
+    bool isSwapped;
+    std::vector<Interface> theInterfaces;
+    std::string theError;
+    uint64_t theFrames;
+    uint64_t theGood;
+    uint64_t theSkipped;
+    uint64_t theBytes;
+    std::vector<Frame> theBad;
+};
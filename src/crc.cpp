@@ -24,8 +24,14 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <cerrno>
 #include <cstring>
 #include <list>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
 #include <getopt.h>
 #include <stdint.h>
 
@@ -34,6 +40,14 @@
 
 #include "CRCInfo.h"
 #include "CRCFactory.h"
+#include "CRCFile.h"
+#include "CRCAnalyzer.h"
+#include "CRCBlockMap.h"
+#include "HexCodec.h"
+#include "HexFile.h"
+#include "PcapFile.h"
+
+#include "crcmetrics.h"
 
 
 
@@ -49,7 +63,10 @@ public:
     virtual unsigned int numBytes() const = 0;
     virtual void describe(std::ostream& s) const = 0;
     virtual void writePoly(std::ostream& s) const = 0;
+    virtual void writeFactors(std::ostream& s) const = 0;
     virtual void writeTable(std::ostream& s) const = 0;
+    virtual void tune(std::ostream& s) const = 0;
+    virtual void getSyndromes(uint64_t* someSyndromes, size_t aCount) const = 0;
     virtual ~ICRCTest() {}
 };
 
@@ -94,10 +111,22 @@ private:
     {
         crcInfo->writeTable(s);
     }
+    void tune(std::ostream& s) const
+    {
+        crcInfo->tune(s);
+    }
     void writePoly(std::ostream& s) const
     {
         crcInfo->writePoly(s);
     }
+    void writeFactors(std::ostream& s) const
+    {
+        crcInfo->writeFactors(s);
+    }
+    void getSyndromes(uint64_t* someSyndromes, size_t aCount) const
+    {
+        crcInfo->getSyndromes(someSyndromes, aCount);
+    }
     void describe(std::ostream& s) const
     {
         writePoly(s);
@@ -174,96 +203,157 @@ private:
 };
 
 
+/**
+ * An entry of the catalog of algorithms.
+ * The catalog is constant data: the engine of an algorithm is only created when it is selected.
+ */
 struct AlgorithmFactory
 {
     char const* name;
-    ICRCTestFactory* factory;
+    ICRCTestFactory* (*create)(uint64_t aGenerator, uint64_t aPreset, uint64_t anInvert);
+    unsigned int numBits;
+    bool isNative;
+    uint64_t generator;
+    uint64_t preset;
+    uint64_t invert;
 };
 
-static AlgorithmFactory algorithms[] =
+template<class P> ICRCTestFactory* createParameters(uint64_t aGenerator, uint64_t aPreset, uint64_t anInvert)
+{
+    return new CRCParameters<P>(aGenerator, aPreset, anInvert);
+}
+
+template<class P> constexpr AlgorithmFactory algorithm(char const* aName, uint64_t aGenerator,
+                                                       uint64_t aPreset = ~0ULL, uint64_t anInvert = ~0ULL)
+{
+    return AlgorithmFactory { aName, &createParameters<P>, P::numbits, !P::reflected, aGenerator,
+                              aPreset & (~0ULL >> (64 - P::numbits)), anInvert & (~0ULL >> (64 - P::numbits)) };
+}
+
+static AlgorithmFactory const algorithms[] =
 {
     // 32-bit tests
 
     // Standard CRC-32 Network Order (Ethernet etc...)
-    { "ieee802.3",  new CRCParameters<CrcPP::Poly32N>(0xEDB88320) },
+    algorithm<CrcPP::Poly32N>("ieee802.3", 0xEDB88320),
 
     // CRC-32 Native order, not inverted
-    { "crc32",  new CRCParameters<CrcPP::Poly32> (0x04C11DB7, ~0, 0) },
+    algorithm<CrcPP::Poly32>("crc32", 0x04C11DB7, ~0ULL, 0),
 
 
     // 16-Bit tests
 
     // Standard CRC-CCITT Network Order (X.25/HDLC)
-    { "ccitt", new CRCParameters<CrcPP::Poly16N> (0x8408) },
+    algorithm<CrcPP::Poly16N>("ccitt", 0x8408),
 
     // CRC-CCITT Native Order, not inverted
-    { "ccitt-native", new CRCParameters<CrcPP::Poly16> (0x1021, ~0, 0) },
+    algorithm<CrcPP::Poly16>("ccitt-native", 0x1021, ~0ULL, 0),
 
     // CRC-CCITT Native Order, inverted
-    { "ccitt-native-inverted", new CRCParameters<CrcPP::Poly16> (0x1021) },
+    algorithm<CrcPP::Poly16>("ccitt-native-inverted", 0x1021),
 
     // CRC-16 (IBM)
-    { "crc16",  new CRCParameters<CrcPP::Poly16> (0x8005, 0, 0) },
+    algorithm<CrcPP::Poly16>("crc16", 0x8005, 0, 0),
 
     // CRC-16 Network order
-    { "crc16n",  new CRCParameters<CrcPP::Poly16N> (0xA001, ~0, 0) },
+    algorithm<CrcPP::Poly16N>("crc16n", 0xA001, ~0ULL, 0),
 
 
     // 8-Bit tests
 
     // 8-Bit CRC ITU-T Network Order, Result exored with 0x55 (ISDN HEC)
-    { "hec", new CRCParameters<CrcPP::Poly8N> (0xE0, 0, 0x55) },
+    algorithm<CrcPP::Poly8N>("hec", 0xE0, 0, 0x55),
 
     // 8-Bit CRC ITU-T Native Order
-    { "crc8", new CRCParameters<CrcPP::Poly8> (0x07, 0, 0) },
+    algorithm<CrcPP::Poly8>("crc8", 0x07, 0, 0),
 
     // 8-Bit CRC SAE J1850
-    { "j1850", new CRCParameters<CrcPP::Poly8> (0x1D) },
+    algorithm<CrcPP::Poly8>("j1850", 0x1D),
 
     // 8-Bit CRC SAE 2F
-    { "sae2f", new CRCParameters<CrcPP::Poly8> (0x2F) },
-    { 0, 0 }
+    algorithm<CrcPP::Poly8>("sae2f", 0x2F),
+    { 0, 0, 0, false, 0, 0, 0 }
 };
 
 
-static AlgorithmFactory generics[] =
+static AlgorithmFactory const generics[] =
 {
     // 32-bit
 
     // CRC-32 Network Order
-    { "g32r",  new CRCParameters<CrcPP::Poly32N>(0) },
+    algorithm<CrcPP::Poly32N>("g32r", 0),
 
     // CRC-32 Native order
-    { "g32",  new CRCParameters<CrcPP::Poly32> (0) },
+    algorithm<CrcPP::Poly32>("g32", 0),
 
 
     // 16-Bit
 
     // 16 Bit Network Order
-    { "g16r", new CRCParameters<CrcPP::Poly16N> (0) },
+    algorithm<CrcPP::Poly16N>("g16r", 0),
 
     // 16 Bit Native Order
-    { "g16", new CRCParameters<CrcPP::Poly16> (0) },
+    algorithm<CrcPP::Poly16>("g16", 0),
 
 
     // 8-Bit
 
     // 8-Bit Network Order
-    { "g8r", new CRCParameters<CrcPP::Poly8N> (0) },
+    algorithm<CrcPP::Poly8N>("g8r", 0),
 
     // 8-Bit Native Order
-    { "g8", new CRCParameters<CrcPP::Poly8> (0) },
-    { 0, 0 }
+    algorithm<CrcPP::Poly8>("g8", 0),
+    { 0, 0, 0, false, 0, 0, 0 }
 };
 
 
-static AlgorithmFactory* lists[] =
+static AlgorithmFactory const* const lists[] =
 {
     generics,
     algorithms,
     0
 };
 
+/**
+ * Describe a catalog entry like ICRCTest::describe(), without creating its engine
+ */
+void describe(AlgorithmFactory const& anAlgorithm, std::ostream& s)
+{
+    s << std::dec << "X^" << anAlgorithm.numBits;
+
+    for (unsigned int i = anAlgorithm.numBits - 1; i > 0; --i)
+    {
+        unsigned int bit = anAlgorithm.isNative ? i : anAlgorithm.numBits - 1 - i;
+
+        if ((anAlgorithm.generator >> bit) & 1)
+        {
+            s << " + X";
+
+            if (i > 1)
+            {
+                s << "^" << i;
+            }
+        }
+    }
+
+    s << " + 1";
+    s << " in " << (anAlgorithm.isNative ? "native" : "network") << " order";
+    s << std::hex;
+    s << std::setfill('0');
+    unsigned int fieldWidth = (anAlgorithm.numBits + 7) / 8 * 2;
+    s << " = 0x" << std::setw(fieldWidth) << anAlgorithm.generator;
+    s << ", preset 0x" << std::setw(fieldWidth) << anAlgorithm.preset;
+    s << ", invert 0x" << std::setw(fieldWidth) << anAlgorithm.invert;
+}
+
+/**
+ * Create the engine of a catalog entry
+ */
+ICRCTestFactory* create(AlgorithmFactory const& anAlgorithm)
+{
+    return anAlgorithm.create(anAlgorithm.generator, anAlgorithm.preset, anAlgorithm.invert);
+}
+
 uint64_t toHex(char const* p, unsigned int maxBytes = 2)
 {
     uint64_t hexData = 0;
@@ -296,85 +386,88 @@ uint64_t toHex(char const* p, unsigned int maxBytes = 2)
     return hexData;
 }
 
-class HexDump
+/**
+ * Parse a size or offset, with an optional suffix K, M, G or T for multiples of 1024
+ * @param p the text
+ * @param aSize receives the value
+ * @return false if the text is not a valid size
+ */
+bool toSize(char const* p, uint64_t& aSize)
 {
-public:
-    HexDump(unsigned char const* someData, unsigned int aLength)
-        : data(someData), size(aLength)
+    char* end;
+    aSize = std::strtoull(p, &end, 0);
+
+    if (end == p)
     {
+        return false;
     }
 
-    unsigned char const* data;
-    unsigned int size;
-};
-
+    static char const suffixes[] = "KMGT";
+    char const* suffix = *end != 0 ? std::strchr(suffixes, *end) : 0;
 
-std::ostream& operator << (std::ostream& stream, HexDump const& d)
-{
-    stream << std::hex;
-
-    // <debug>
-    for (unsigned int i = 0; i < d.size; i++)
+    if (suffix != 0)
     {
-        if (i > 0)
-        {
-            if ((i % 16) == 0)
-            {
-                stream << std::endl;
-            }
-            else if ((i % 8) == 0)
-            {
-                stream << "\t";
-            }
-        }
-
-        unsigned int value = static_cast<unsigned int>(d.data[i]);
-
-        if (value < 0x10)
-        {
-            stream << " 0" << value;
-        }
-        else
-        {
-            stream << " " << value;
-        }
+        aSize <<= 10 * (suffix - suffixes + 1);
+        ++end;
     }
 
-    stream << std::dec;
-    return stream;
+    return *end == 0;
 }
 
 void usage(char* progname)
 {
     std::cerr << "Usage:" << std::endl <<
               progname << " -a algo | --algorithm=algo [-b] xx xx xx ... " << std::endl <<
-              progname << " -a algo | --algorithm=algo -w | --write-table " << std::endl
+              progname << " -a algo | --algorithm=algo [-b] -f file | --file=file" << std::endl <<
+              progname << " -a algo | --algorithm=algo [-b] -c | --copy source destination" << std::endl <<
+              progname << " -a algo | --algorithm=algo [-b] -l file | --follow=file -S statefile | --state=statefile" << std::endl <<
+              progname << " -a algo | --algorithm=algo [-b] [-F] -x file | --hex-file=file" << std::endl <<
+              progname << " [-a algo | --algorithm=algo] -P file | --pcap=file" << std::endl <<
+              progname << " -a algo | --algorithm=algo [-B size] -f file -m map | --map=map" << std::endl <<
+              progname << " -a algo | --algorithm=algo -f file -C map | --check-map=map [-R offset[:length]]" << std::endl <<
+              progname << " -a algo | --algorithm=algo [-B size] -D | --diff file-or-map file-or-map" << std::endl <<
+              progname << " -a algo | --algorithm=algo -w | --write-table " << std::endl <<
+              progname << " -a algo | --algorithm=algo -A bits | --analyze=bits" << std::endl <<
+              progname << " -a algo | --algorithm=algo -T | --tune" << std::endl
               << "    where xx are pairs of hex digits" << std::endl << std::endl;
     std::cerr << "Options:" << std::endl;
+    std::cerr << "-A | --analyze   factor the generator, compute Hamming distance and low weight codewords for messages up to bits long" << std::endl;
     std::cerr << "-b | --binary    binary output" << std::endl;
+    std::cerr << "-B | --block-size block size for --map and --diff, with suffix K, M or G (default 4M)" << std::endl;
+    std::cerr << "-c | --copy      copy source to destination and compute CRC of the data copied" << std::endl;
+    std::cerr << "-C | --check-map compare the blocks of file with a map, list blocks which differ" << std::endl;
+    std::cerr << "-D | --diff      compare two files or maps block by block, list blocks which differ" << std::endl;
+    std::cerr << "-f | --file      compute CRC of file contents instead of hex data (- for stdin)" << std::endl;
+    std::cerr << "-F | --frames    with --hex-file: compute a CRC for each line (plain hex) or each dump (separated by empty lines)" << std::endl;
     std::cerr << "-g | --generator specify generator polynomial in hex" << std::endl;
     std::cerr << "-i | --invert    specify invert (xor) in hex" << std::endl;
+    std::cerr << "-l | --follow    compute CRC of a growing file, adding only the data appended since the state was saved" << std::endl;
+    std::cerr << "-m | --map       compute the CRC of each block of file in parallel, and save them to map" << std::endl;
+    std::cerr << "-M | --stats     write bytes, calls, kernels, sizes and latencies of the CRC calculations to stderr,\n                 as --stats=prometheus (the default) or --stats=json" << std::endl;
     std::cerr << "-p | --preset    specify preset value in hex" << std::endl;
-    std::cerr << "-v | --verify    exit with status 0 if CRC is OK, 1 if bad" << std::endl << std::endl;
+    std::cerr << "-S | --state     with --follow: file holding the state of the calculation, created if it does not exist" << std::endl;
+    std::cerr << "-R | --range     with --check-map: only check the blocks overlapping the range of bytes" << std::endl;
+    std::cerr << "-P | --pcap      check the FCS of each Ethernet frame in a pcap or pcapng file (default algo: ieee802.3)" << std::endl;
+    std::cerr << "-T | --tune      measure the kernels and tables for algo on this CPU, and cache the fastest for each data size.\n                 The cache is used if the environment variable CRCPP_TUNING names it" << std::endl;
+    std::cerr << "-v | --verify    exit with status 0 if CRC is OK, 1 if bad" << std::endl;
+    std::cerr << "-x | --hex-file  compute CRC of hex data read from file (- for stdin): plain, xxd, od -A x -t x1z or hexdump -C" << std::endl << std::endl;
     std::cerr << "If generator, invert or preset is used, algo must be specified first (to determine the number of bytes)" << std::endl << std::endl;
     std::cerr << "algo is one of: " << std::endl;
 
-    for (AlgorithmFactory* a = algorithms; a->name; ++a)
+    for (AlgorithmFactory const* a = algorithms; a->name; ++a)
     {
         std::cerr << "  " << a->name << " ";
-        a->factory->createTest()->describe(std::cerr);
+        describe(*a, std::cerr);
         std::cerr << std::endl;
     }
 
     std::cerr << std::endl << "Additionally, one of the following generic specifications may be used: " << std::dec << std::endl;
 
-    for (AlgorithmFactory* a = generics; a->name; ++a)
+    for (AlgorithmFactory const* a = generics; a->name; ++a)
     {
-        ICRCTestFactory& f = *a->factory;
-
         std::cerr << "  " << a->name << " " <<
 
-                  f.numBits() << " bits, " << (f.isNative() ? "native" : "network") << " order";
+                  a->numBits << " bits, " << (a->isNative ? "native" : "network") << " order";
 
         std::cerr << std::endl;
     }
@@ -384,27 +477,93 @@ void usage(char* progname)
     std::cerr << progname << " -s | --search xx xx xx ... search for algorithm giving good crc with that data" << std::endl << std::endl;
 }
 
+/**
+ * Writes the metrics of the CRC calculations to stderr when main() returns
+ */
+class StatsReport
+{
+public:
+    StatsReport(char const* aFormat) :
+        format(aFormat)
+    {
+        if (format != 0)
+        {
+            CrcPP::CRCMetrics::enable();
+        }
+    }
+    ~StatsReport()
+    {
+        if (format == 0)
+        {
+            return;
+        }
+
+        if (std::strcmp(format, "json") == 0)
+        {
+            CrcPP::MetricsWriter::writeJSON(std::cerr, CrcPP::CRCMetrics::snapshot());
+        }
+        else
+        {
+            CrcPP::MetricsWriter::writePrometheus(std::cerr, CrcPP::CRCMetrics::snapshot());
+        }
+    }
+private:
+    char const* format;
+};
+
 int main(int argc, char* argv[])
 {
-    ICRCTestFactory* theFactory = 0;
+    std::unique_ptr<ICRCTestFactory> theFactory;
     bool doWriteTable = false;
+    bool doTune = false;
     bool doSearch = false;
     bool doVerify = false;
     int  verbosity = 0;
     bool binaryOutput = false;
+    char const* fileName = 0;
+    bool doCopy = false;
+    char const* hexFileName = 0;
+    bool doFrames = false;
+    char const* pcapName = 0;
+    char const* mapName = 0;
+    char const* checkMapName = 0;
+    bool doDiff = false;
+    char const* followName = 0;
+    char const* stateName = 0;
+    uint64_t blockSize = CRCBlockMap::defaultBlockSize;
+    uint64_t rangeOffset = 0;
+    uint64_t rangeLength = ~static_cast<uint64_t>(0);
+    unsigned long analyzeBits = 0;
+    char const* statsFormat = 0;
+    AlgorithmFactory const* theAlgorithm = 0;
 
     static struct option longOptions[] =
     {
         {"algorithm", 1, 0, 'a'},
+        {"analyze", 1, 0, 'A'},
         {"binary", 0, 0, 'b'},
+        {"block-size", 1, 0, 'B'},
+        {"check-map", 1, 0, 'C'},
+        {"copy", 0, 0, 'c'},
+        {"diff", 0, 0, 'D'},
+        {"file", 1, 0, 'f'},
+        {"follow", 1, 0, 'l'},
+        {"frames", 0, 0, 'F'},
         {"generator", 1, 0, 'g'},
         {"help", 0, 0, 'h'},
         {"invert", 1, 0, 'i'},
+        {"map", 1, 0, 'm'},
+        {"stats", 2, 0, 'M'},
         {"preset", 1, 0, 'p'},
+        {"pcap", 1, 0, 'P'},
+        {"range", 1, 0, 'R'},
         {"search", 0, 0, 's'},
+        {"state", 1, 0, 'S'},
+        {"tune", 0, 0, 'T'},
         {"verbose", 0, 0, 'V'},
         {"verify", 0, 0, 'v'},
         {"write-table", 0, 0, 'w'},
+        {"hex-file", 1, 0, 'x'},
         {0, 0, 0, 0}
     };
 
@@ -419,7 +578,7 @@ int main(int argc, char* argv[])
     do
     {
         int optionIndex = 0;
-        int opt = ::getopt_long(argc, argv, "a:bg:hi:p:svVw", longOptions, &optionIndex);
+        int opt = ::getopt_long(argc, argv, "a:A:bB:cC:Df:Fg:hi:l:m:M::p:P:R:sS:TvVwx:", longOptions, &optionIndex);
 
         if (opt == -1)
         {
@@ -433,13 +592,16 @@ int main(int argc, char* argv[])
 
             case 'a':
             {
-                for (AlgorithmFactory** list = lists; *list != 0; ++list)
+                theFactory.reset();
+
+                for (AlgorithmFactory const* const* list = lists; *list != 0; ++list)
                 {
-                    for (AlgorithmFactory* a = *list; a->name; ++a)
+                    for (AlgorithmFactory const* a = *list; a->name; ++a)
                     {
                         if (std::strcmp(a->name, optarg) == 0)
                         {
-                            theFactory = a->factory;
+                            theFactory.reset(create(*a));
+                            theAlgorithm = a;
                             break;
                         }
                     }
@@ -459,10 +621,52 @@ int main(int argc, char* argv[])
             }
             break;
 
+            case 'A':
+                analyzeBits = std::strtoul(optarg, 0, 0);
+
+                if (analyzeBits == 0 || analyzeBits >= CRCAnalyzer::maxLength)
+                {
+                    std::cerr << "Invalid message length for --analyze: " << optarg << std::endl;
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                break;
+
             case 'b':
                 binaryOutput = true;
                 break;
 
+            case 'B':
+                if (!toSize(optarg, blockSize) || blockSize == 0)
+                {
+                    std::cerr << "Invalid block size: " << optarg << std::endl;
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                break;
+
+            case 'c':
+                doCopy = true;
+                break;
+
+            case 'C':
+                checkMapName = optarg;
+                break;
+
+            case 'D':
+                doDiff = true;
+                break;
+
+            case 'f':
+                fileName = optarg;
+                break;
+
+            case 'F':
+                doFrames = true;
+                break;
+
             case 'g':
                 if (theFactory == 0)
                 {
@@ -497,6 +701,14 @@ int main(int argc, char* argv[])
 
                 break;
 
+            case 'l':
+                followName = optarg;
+                break;
+
+            case 'm':
+                mapName = optarg;
+                break;
+
             case 'p':
                 if (theFactory == 0)
                 {
@@ -512,10 +724,54 @@ int main(int argc, char* argv[])
 
                 break;
 
+            case 'P':
+                pcapName = optarg;
+                break;
+
+            case 'R':
+            {
+                std::string range(optarg);
+                size_t colon = range.find(':');
+
+                if (!toSize(range.substr(0, colon).c_str(), rangeOffset) ||
+                    (colon != std::string::npos && !toSize(range.substr(colon + 1).c_str(), rangeLength)))
+                {
+                    std::cerr << "Invalid range: " << optarg << std::endl;
+                    usage(argv[0]);
+                    return 1;
+                }
+            }
+            break;
+
             case 's':
                 doSearch = true;
                 break;
 
+            case 'S':
+                stateName = optarg;
+                break;
+
+            case 'M':
+                if (optarg == 0)
+                {
+                    statsFormat = "prometheus";
+                    break;
+                }
+
+                if (std::strcmp(optarg, "prometheus") != 0 && std::strcmp(optarg, "json") != 0)
+                {
+                    std::cerr << "Invalid format for --stats: " << optarg << std::endl;
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                statsFormat = optarg;
+                break;
+
+            case 'T':
+                doTune = true;
+                break;
+
             case 'v':
                 doVerify = true;
                 break;
@@ -527,10 +783,56 @@ int main(int argc, char* argv[])
             case 'w':
                 doWriteTable = true;
                 break;
+
+            case 'x':
+                hexFileName = optarg;
+                break;
         }
     }
     while (true);    // end by explicit break
 
+    if ((pcapName != 0) && (doSearch || doWriteTable || doCopy || doFrames || (fileName != 0) || (hexFileName != 0) || argc > optind))
+    {
+        std::cerr << "--pcap cannot be combined with --search, --write-table, --copy, --file, --hex-file or hex data." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (((mapName != 0) || (checkMapName != 0)) && ((fileName == 0) || doSearch || doWriteTable || doCopy || (pcapName != 0) || argc > optind))
+    {
+        std::cerr << "--map and --check-map need --file, and cannot be combined with --search, --write-table, --copy, --pcap or hex data." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (doDiff && ((mapName != 0) || (checkMapName != 0) || (fileName != 0) || doSearch || doWriteTable || doCopy || (pcapName != 0) || argc - optind != 2))
+    {
+        std::cerr << "--diff needs two files or maps, and cannot be combined with other modes." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (((followName != 0) != (stateName != 0)) ||
+        ((followName != 0) && (doSearch || doWriteTable || doCopy || doDiff || (fileName != 0) || (hexFileName != 0) || (pcapName != 0) || argc > optind)))
+    {
+        std::cerr << "--follow and --state must be used together, and cannot be combined with other modes or hex data." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if ((pcapName != 0) && (theFactory == 0))
+    {
+        // Ethernet FCS
+        for (AlgorithmFactory const* a = algorithms; a->name; ++a)
+        {
+            if (std::strcmp(a->name, "ieee802.3") == 0)
+            {
+                theFactory.reset(create(*a));
+                theAlgorithm = a;
+            }
+        }
+    }
+
     if ((theFactory == 0) && !doSearch)
     {
         std::cerr << "No algorithm selected." << std::endl;
@@ -545,6 +847,34 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    if ((fileName != 0) && (doSearch || doWriteTable || argc > optind))
+    {
+        std::cerr << "--file cannot be combined with --search, --write-table or hex data." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (doCopy && (doSearch || doWriteTable || (fileName != 0) || argc - optind != 2))
+    {
+        std::cerr << "--copy needs a source and a destination, and cannot be combined with --search, --write-table or --file." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if ((hexFileName != 0) && (doSearch || doWriteTable || doCopy || (fileName != 0) || argc > optind))
+    {
+        std::cerr << "--hex-file cannot be combined with --search, --write-table, --copy, --file or hex data." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (doFrames && (hexFileName == 0))
+    {
+        std::cerr << "--frames needs --hex-file." << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+
     if (doWriteTable && doSearch)
     {
         std::cerr << "--search and --write-table are mutually exclusive." << std::endl;
@@ -552,16 +882,27 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    StatsReport stats(statsFormat);
+
+    // The calls are recorded under the generator actually used, which --generator may have changed.
+    // Another polynomial is not the named algorithm, so it keeps the label of its width and generator.
+    if ((statsFormat != 0) && (theAlgorithm != 0) && (theFactory->getFactory().generator() == theAlgorithm->generator))
+    {
+        CrcPP::CRCMetrics::Algorithm algorithm = { theFactory->getFactory().generator(), theAlgorithm->numBits, !theAlgorithm->isNative };
+        CrcPP::CRCMetrics::setName(algorithm, theAlgorithm->name);
+    }
+
     if (doSearch)
     {
         bool found = false;
         std::list<uint8_t> src;
+        HexWriter echo(std::cout);
 
         while (argc > optind)
         {
             uint8_t nextByte = (uint8_t) toHex(argv[optind]);
             src.push_back(nextByte);
-            std::cout << HexDump(&nextByte, 1);
+            echo.hex(&nextByte, 1);
             ++optind;
         }
 
@@ -572,11 +913,12 @@ int main(int argc, char* argv[])
             return 1;
         }
 
-        std::cout << std::endl;
+        echo.text("\n").flush();
 
-        for (AlgorithmFactory* a = algorithms; a->name; ++a)
+        for (AlgorithmFactory const* a = algorithms; a->name; ++a)
         {
-            ICRCTest* aTest = a->factory->createTest();
+            std::unique_ptr<ICRCTestFactory> aFactory(create(*a));
+            std::unique_ptr<ICRCTest> aTest(aFactory->createTest());
             ICRCAlgorithm* algo = aTest->getAlgorithm();
 
             for (std::list<uint8_t>::const_iterator it = src.begin(); it != src.end(); ++it)
@@ -624,13 +966,310 @@ int main(int argc, char* argv[])
         return 0;
     }
 
+    if (doTune)
+    {
+        theTest->tune(std::cout);
+        return 0;
+    }
+
+    if (analyzeBits > 0)
+    {
+        std::vector<uint64_t> syndromes(analyzeBits + theTest->numBits());
+        theTest->getSyndromes(&syndromes[0], syndromes.size());
+
+        CRCAnalyzer analyzer(syndromes, theTest->numBits());
+        analyzer.run();
+
+        theTest->writePoly(std::cout);
+        std::cout << std::endl << "= ";
+        theTest->writeFactors(std::cout);
+        std::cout << std::endl << std::endl;
+        analyzer.report(std::cout);
+        return 0;
+    }
+
+    // When copying to standard output, all other output goes to standard error
+    std::ostream& out = (doCopy && std::strcmp(argv[argc - 1], "-") == 0) ? std::cerr : std::cout;
+
     if (verbosity > 0)
     {
-        theTest->describe(std::cout);
-        std::cout << std::endl;
+        theTest->describe(out);
+        out << std::endl;
     }
 
     ICRCAlgorithm* algo = theTest->getAlgorithm();
+    HexWriter writer(out);
+
+    if ((mapName != 0) || (checkMapName != 0) || doDiff)
+    {
+        uint64_t generator = theFactory->getFactory().generator();
+        CRCBlockMap map(*algo, generator, theTest->numBits(), theTest->isNative());
+        std::vector<uint64_t> differ;
+
+        if (mapName != 0)
+        {
+            if (!map.build(fileName, blockSize) || !map.save(mapName))
+            {
+                std::cerr << "ERROR: " << map.error() << std::endl;
+                return 1;
+            }
+
+            if (verbosity > 0)
+            {
+                out << std::dec << map.numBlocks() << " blocks of " << map.blockSize() << " bytes" << std::endl;
+            }
+
+            // The CRC of the whole file
+            map.addTo(*algo);
+        }
+        else if (checkMapName != 0)
+        {
+            if (!map.load(checkMapName) || !map.verify(fileName, rangeOffset, rangeLength, differ))
+            {
+                std::cerr << "ERROR: " << map.error() << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            // Maps are loaded, files are read with the block size of the map, if any
+            CRCBlockMap other(*algo, generator, theTest->numBits(), theTest->isNative());
+            CRCBlockMap* maps[] = { &map, &other };
+            bool isMap[] = { CRCBlockMap::isMap(argv[optind]), CRCBlockMap::isMap(argv[optind + 1]) };
+
+            for (int i = 0; i < 2; ++i)
+            {
+                if (isMap[i] && !maps[i]->load(argv[optind + i]))
+                {
+                    std::cerr << "ERROR: " << maps[i]->error() << std::endl;
+                    return 1;
+                }
+            }
+
+            for (int i = 0; i < 2; ++i)
+            {
+                uint64_t size = isMap[1 - i] ? maps[1 - i]->blockSize() : blockSize;
+
+                if (!isMap[i] && !maps[i]->build(argv[optind + i], size))
+                {
+                    std::cerr << "ERROR: " << maps[i]->error() << std::endl;
+                    return 1;
+                }
+            }
+
+            if (!map.diff(other, differ))
+            {
+                std::cerr << "ERROR: " << map.error() << std::endl;
+                return 1;
+            }
+        }
+
+        if (mapName == 0)
+        {
+            for (size_t i = 0; i < differ.size(); ++i)
+            {
+                out << std::dec << "block " << differ[i] << " at offset " << differ[i] * map.blockSize() << " differs" << std::endl;
+            }
+
+            uint64_t compared = checkMapName != 0 ? map.numBlocks(rangeOffset, rangeLength) : map.numBlocks();
+            out << std::dec << differ.size() << " of " << compared << " blocks differ" << std::endl;
+            return differ.empty() ? 0 : 1;
+        }
+    }
+    else if (followName != 0)
+    {
+        // Continue from the saved state, if any
+        std::ifstream stateFile(stateName, std::ios::binary);
+
+        if (stateFile)
+        {
+            std::string state((std::istreambuf_iterator<char>(stateFile)), std::istreambuf_iterator<char>());
+
+            if (!algo->importState(ICRCAlgorithm::ByteString(state.begin(), state.end())))
+            {
+                std::cerr << "ERROR: " << stateName << " is not a state of this algorithm" << std::endl;
+                return 1;
+            }
+        }
+
+        CRCFile file(followName);
+        uint64_t offset = algo->length();
+
+        if (!file.isOpen() || !file.skip(offset) || !file.addTo(*algo))
+        {
+            std::cerr << "ERROR: Cannot read " << followName << " from offset " << offset << ": " << std::strerror(errno) << std::endl;
+
+            if (errno == EINVAL)
+            {
+                std::cerr << "The file is shorter than the saved state, it may have been rotated. Remove " << stateName << " to start over." << std::endl;
+            }
+
+            return 1;
+        }
+
+        // Replace the state file only when the new state is complete
+        std::string newName = std::string(stateName) + ".new";
+        ICRCAlgorithm::ByteString state = algo->exportState();
+        std::ofstream newFile(newName.c_str(), std::ios::binary | std::ios::trunc);
+        newFile.write(reinterpret_cast<char const*>(state.data()), static_cast<std::streamsize>(state.size()));
+        newFile.close();
+
+        if (!newFile || std::rename(newName.c_str(), stateName) != 0)
+        {
+            std::cerr << "ERROR: Cannot write " << stateName << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        if (verbosity > 0)
+        {
+            out << std::dec << algo->length() - offset << " bytes added, " << algo->length() << " bytes in total" << std::endl;
+        }
+    }
+    else if (fileName != 0)
+    {
+        CRCFile file(fileName);
+
+        if (!file.isOpen() || !file.addTo(*algo))
+        {
+            std::cerr << "ERROR: Cannot read " << fileName << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        if (verbosity > 0)
+        {
+            out << std::dec << file.bytesRead() << " bytes read, " << file.bytesSkipped() << " bytes in holes" << std::endl;
+        }
+    }
+
+    if (pcapName != 0)
+    {
+        PcapFile capture(pcapName);
+
+        if (!capture.isOpen())
+        {
+            std::cerr << "ERROR: Cannot read " << pcapName << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        bool complete = capture.check(*algo);
+        std::vector<PcapFile::Frame> const& bad = capture.badFrames();
+
+        for (size_t i = 0; i < bad.size(); ++i)
+        {
+            out << std::dec << "frame " << bad[i].number << ": bad FCS, " << bad[i].length << " bytes" << std::endl;
+        }
+
+        out << std::dec << capture.frames() << " frames, " << capture.goodFrames() << " good, " << bad.size() << " bad, "
+            << capture.skippedFrames() << " skipped" << std::endl;
+
+        if (verbosity > 0)
+        {
+            out << capture.bytesChecked() << " bytes checked" << std::endl;
+        }
+
+        if (!complete)
+        {
+            std::cerr << "ERROR: " << pcapName << ": " << capture.error() << std::endl;
+            return 1;
+        }
+
+        return bad.empty() ? 0 : 1;
+    }
+
+    if (doFrames)
+    {
+        // One result per frame, --verify fails if any frame is bad
+        HexFile file(hexFileName);
+        std::vector<uint8_t> frame;
+        bool allGood = true;
+
+        if (!file.isOpen())
+        {
+            std::cerr << "ERROR: Cannot read " << hexFileName << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        while (file.nextFrame(frame))
+        {
+            algo->reset();
+            algo->addBytes(&frame[0], frame.size());
+
+            ICRCAlgorithm::ByteString res = algo->result();
+            bool good = algo->good();
+            allGood = allGood && good;
+
+            if (binaryOutput)
+            {
+                writer.raw(res.c_str(), res.size());
+            }
+            else
+            {
+                writer.hex(res.c_str(), res.size());
+
+                if (doVerify)
+                {
+                    writer.text(good ? " (OK)" : " (BAD)");
+                }
+
+                writer.text("\n");
+            }
+        }
+
+        writer.flush();
+
+        if (!file.error().empty())
+        {
+            std::cerr << "ERROR: " << hexFileName << ": " << file.error() << std::endl;
+            return 1;
+        }
+
+        if (verbosity > 0)
+        {
+            out << std::dec << file.bytesDecoded() << " bytes decoded" << std::endl;
+        }
+
+        return !doVerify || allGood ? 0 : 1;
+    }
+
+    if (hexFileName != 0)
+    {
+        HexFile file(hexFileName);
+
+        if (!file.isOpen())
+        {
+            std::cerr << "ERROR: Cannot read " << hexFileName << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        if (!file.addTo(*algo))
+        {
+            std::cerr << "ERROR: " << hexFileName << ": " << file.error() << std::endl;
+            return 1;
+        }
+
+        if (verbosity > 0)
+        {
+            out << std::dec << file.bytesDecoded() << " bytes decoded" << std::endl;
+        }
+    }
+
+    if (doCopy)
+    {
+        CRCFile file(argv[optind]);
+
+        if (!file.isOpen() || !file.copyTo(argv[optind + 1], *algo))
+        {
+            std::cerr << "ERROR: Cannot copy " << argv[optind] << " to " << argv[optind + 1] << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        if (verbosity > 0)
+        {
+            out << std::dec << file.bytesRead() << " bytes copied, " << file.bytesSkipped() << " bytes in holes" << std::endl;
+        }
+
+        optind = argc;
+    }
 
     while (argc > optind)
     {
@@ -639,11 +1278,11 @@ int main(int argc, char* argv[])
 
         if (binaryOutput)
         {
-            std::cout << nextByte;
+            writer.raw(&nextByte, 1);
         }
         else
         {
-            std::cout << HexDump(&nextByte, 1);
+            writer.hex(&nextByte, 1);
         }
 
         ++optind;
@@ -653,19 +1292,20 @@ int main(int argc, char* argv[])
 
     if (binaryOutput)
     {
-        std::cout.write(reinterpret_cast<char const*>(res.c_str()), res.size());
+        writer.raw(res.c_str(), res.size());
     }
     else
     {
-        std::cout << HexDump(res.c_str(), res.size());
+        writer.hex(res.c_str(), res.size());
 
         if (doVerify)
         {
-            std::cout << (theTest->getAlgorithm()->good() ? " (OK)" : " (BAD)");
+            writer.text(theTest->getAlgorithm()->good() ? " (OK)" : " (BAD)");
         }
 
-        std::cout << std::endl;
+        writer.text("\n");
     }
 
+    writer.flush();
     return !doVerify || theTest->getAlgorithm()->good() ? 0 : 1;
 }
@@ -0,0 +1,51 @@
+/*
+ * crcpp.cpp
+ *
+ * This file is part of CRC++
+ *
+ * Copyright (c) 2026 ALDEA Software und Systeme GmbH, Tuebingen, Germany
+ * Author: Adrian Weiler
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+/*
+ * The explicit instantiations of the crcpp library.
+ * Code built with CRCPP_EXTERN_TEMPLATES links against these instead of compiling
+ * CRC<> and CRCStream<> for the standard polynomials in every translation unit.
+ */
+
+#include "crc.h"
+#include "crcstream.h"
+
+namespace CrcPP
+{
+    template class CRC<Poly64N>;
+    template class CRC<Poly32N>;
+    template class CRC<Poly16N>;
+    template class CRC<Poly8N>;
+    template class CRC<Poly64>;
+    template class CRC<Poly32>;
+    template class CRC<Poly16>;
+    template class CRC<Poly8>;
+
+    template class CRCStream<Poly64N>;
+    template class CRCStream<Poly32N>;
+    template class CRCStream<Poly16N>;
+    template class CRCStream<Poly8N>;
+    template class CRCStream<Poly64>;
+    template class CRCStream<Poly32>;
+    template class CRCStream<Poly16>;
+    template class CRCStream<Poly8>;
+}